@@ -0,0 +1,333 @@
+#ifndef BOX_TREE_H
+#define BOX_TREE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace {
+    // closed boxes meet when they share at least a point, a NaN coordinate meets nothing
+    inline bool boxesMeet(double const * low1, double const * high1, double const * low2, double const * high2, size_t dim) {
+        for (size_t i = 0; i < dim; i++) {
+            if (!(low1[i] <= high2[i] && low2[i] <= high1[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // the boxes share more than a boundary: the first one is met along its flat axes and overlapped along the others
+    inline bool boxesOverlap(double const * low1, double const * high1, double const * low2, double const * high2, size_t dim) {
+        for (size_t i = 0; i < dim; i++) {
+            double width = std::min(high1[i], high2[i]) - std::max(low1[i], low2[i]);
+            if (width < 0 || (width == 0 && high1[i] > low1[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // pieces of the box out of cut, cut off one axis after another, so they do not overlap;
+    // pieces thinner than tolerance along the axis they are cut across are dropped
+    inline void subtractBox(double const * low, double const * high, double const * cut_low, double const * cut_high,
+                            size_t dim, double tolerance, std::vector<double> & pieces) {
+        if (!boxesOverlap(low, high, cut_low, cut_high, dim)) {
+            pieces.insert(pieces.end(), low, low + dim);
+            pieces.insert(pieces.end(), high, high + dim);
+            return;
+        }
+        std::vector<double> cur(low, low + dim);
+        cur.insert(cur.end(), high, high + dim);
+        for (size_t i = 0; i < dim; i++) {
+            if (cut_low[i] > cur[i] && !(cut_low[i] - cur[i] < tolerance)) {
+                size_t piece = pieces.size();
+                pieces.insert(pieces.end(), cur.begin(), cur.end());
+                pieces[piece + dim + i] = cut_low[i];
+            }
+            if (cut_high[i] < cur[dim + i] && !(cur[dim + i] - cut_high[i] < tolerance)) {
+                size_t piece = pieces.size();
+                pieces.insert(pieces.end(), cur.begin(), cur.end());
+                pieces[piece + i] = cut_high[i];
+            }
+            cur[i] = std::max(cur[i], cut_low[i]);
+            cur[dim + i] = std::min(cur[dim + i], cut_high[i]);
+        }
+    }
+
+    // R-tree over boxes kept as their least and greatest corners one after another; packed at once by
+    // sort-tile-recursive loading: entries are sorted along the first axis, cut into slabs, every slab sorted
+    // along the next axis and so on, then nodes take runs of entries; insertion goes down to the child
+    // growing least and splits overflowing nodes in halves along the axis of the widest spread
+    class BoxTree {
+    public:
+        static size_t const NODE_CAPACITY = 16;
+        static size_t const NONE = SIZE_MAX;
+
+        explicit BoxTree(size_t dim) : _dim(dim) {
+        }
+
+        size_t getDim() const {
+            return _dim;
+        }
+
+        size_t size() const {
+            return _boxes.size() / (2 * _dim);
+        }
+
+        std::vector<double> const & boxes() const {
+            return _boxes;
+        }
+
+        double const * low(size_t id) const {
+            return _boxes.data() + id * 2 * _dim;
+        }
+
+        double const * high(size_t id) const {
+            return low(id) + _dim;
+        }
+
+        // boxes one after another, each as its least and greatest corners
+        void build(std::vector<double> const & boxes) {
+            _boxes = boxes;
+            _nodes.clear();
+            _bounds.clear();
+            _root = NONE;
+            std::vector<size_t> level(size());
+            std::iota(level.begin(), level.end(), 0);
+            for (bool leaves = true; level.size() > 1 || (leaves && !level.empty()); leaves = false) {
+                std::vector<size_t> nodes;
+                pack(level.begin(), level.end(), 0, leaves, nodes);
+                level.swap(nodes);
+            }
+            _root = level.empty() ? NONE : level[0];
+        }
+
+        void insert(double const * box_low, double const * box_high) {
+            size_t id = size();
+            _boxes.insert(_boxes.end(), box_low, box_low + _dim);
+            _boxes.insert(_boxes.end(), box_high, box_high + _dim);
+            if (_root == NONE) {
+                _root = makeNode(true, std::vector<size_t>(1, id));
+                return;
+            }
+            size_t sibling = insertInto(_root, id);
+            if (sibling != NONE) {
+                std::vector<size_t> entries = {_root, sibling};
+                _root = makeNode(false, entries);
+            }
+        }
+
+        // visit(id) for boxes meeting the given one until it returns true, true if it did
+        template <class Visit>
+        bool search(double const * query_low, double const * query_high, Visit visit) const {
+            if (_root == NONE) {
+                return false;
+            }
+            std::vector<size_t> stack(1, _root);
+            while (!stack.empty()) {
+                size_t node = stack.back();
+                stack.pop_back();
+                if (!boxesMeet(nodeLow(node), nodeLow(node) + _dim, query_low, query_high, _dim)) {
+                    continue;
+                }
+                for (auto entry : _nodes[node].entries) {
+                    if (!_nodes[node].leaf) {
+                        stack.push_back(entry);
+                    } else if (boxesMeet(low(entry), high(entry), query_low, query_high, _dim) && visit(entry)) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // ids of the boxes holding every point in increasing order, ids[offsets[k]..offsets[k + 1]) for point k
+        void classify(double const * points, size_t count, std::vector<size_t> & offsets, std::vector<size_t> & ids) const {
+            offsets.assign(1, 0);
+            ids.clear();
+            for (size_t k = 0; k < count; k++) {
+                double const * point = points + k * _dim;
+                search(point, point, [&ids](size_t id) {
+                    ids.push_back(id);
+                    return false;
+                });
+                std::sort(ids.begin() + offsets.back(), ids.end());
+                offsets.push_back(ids.size());
+            }
+        }
+
+        // the box lies in the union of the boxes: nothing is left of it when the boxes meeting it are cut out
+        bool covers(double const * box_low, double const * box_high, double tolerance) const {
+            std::vector<size_t> cuts;
+            search(box_low, box_high, [&cuts](size_t id) {
+                cuts.push_back(id);
+                return false;
+            });
+            std::vector<double> pieces(box_low, box_low + _dim), rest;
+            pieces.insert(pieces.end(), box_high, box_high + _dim);
+            for (size_t k = 0; k < cuts.size() && !pieces.empty(); k++) {
+                rest.clear();
+                for (size_t p = 0; p < pieces.size(); p += 2 * _dim) {
+                    subtractBox(pieces.data() + p, pieces.data() + p + _dim, low(cuts[k]), high(cuts[k]), _dim, tolerance, rest);
+                }
+                pieces.swap(rest);
+            }
+            return pieces.empty();
+        }
+
+    private:
+        struct Node {
+            bool leaf;
+            std::vector<size_t> entries;
+        };
+
+        double const * nodeLow(size_t node) const {
+            return _bounds.data() + node * 2 * _dim;
+        }
+
+        double const * entryLow(bool leaf, size_t entry) const {
+            return leaf ? low(entry) : nodeLow(entry);
+        }
+
+        double center(bool leaf, size_t entry, size_t axis) const {
+            double const * cur = entryLow(leaf, entry);
+            return (cur[axis] + cur[_dim + axis]) / 2;
+        }
+
+        size_t makeNode(bool leaf, std::vector<size_t> const & entries) {
+            _nodes.push_back(Node {leaf, entries});
+            _bounds.resize(_bounds.size() + 2 * _dim);
+            updateBounds(_nodes.size() - 1);
+            return _nodes.size() - 1;
+        }
+
+        void updateBounds(size_t node) {
+            double * bounds = _bounds.data() + node * 2 * _dim;
+            std::fill(bounds, bounds + _dim, INFINITY);
+            std::fill(bounds + _dim, bounds + 2 * _dim, -INFINITY);
+            for (auto entry : _nodes[node].entries) {
+                double const * cur = entryLow(_nodes[node].leaf, entry);
+                for (size_t i = 0; i < _dim; i++) {
+                    bounds[i] = std::min(bounds[i], cur[i]);
+                    bounds[_dim + i] = std::max(bounds[_dim + i], cur[_dim + i]);
+                }
+            }
+        }
+
+        void sortAlong(std::vector<size_t>::iterator first, std::vector<size_t>::iterator last, bool leaf, size_t axis) const {
+            std::sort(first, last, [this, leaf, axis](size_t a, size_t b) {
+                return center(leaf, a, axis) < center(leaf, b, axis);
+            });
+        }
+
+        void pack(std::vector<size_t>::iterator first, std::vector<size_t>::iterator last, size_t axis, bool leaves,
+                  std::vector<size_t> & nodes) {
+            size_t count = last - first;
+            sortAlong(first, last, leaves, axis);
+            if (axis + 1 == _dim || count <= NODE_CAPACITY) {
+                for (size_t k = 0; k < count; k += NODE_CAPACITY) {
+                    nodes.push_back(makeNode(leaves, std::vector<size_t>(first + k, first + std::min(count, k + NODE_CAPACITY))));
+                }
+                return;
+            }
+            size_t node_count = (count - 1) / NODE_CAPACITY + 1;
+            size_t slabs = (size_t)std::ceil(std::pow((double)node_count, 1.0 / (_dim - axis)));
+            size_t slab_size = ((node_count - 1) / slabs + 1) * NODE_CAPACITY;
+            for (size_t k = 0; k < count; k += slab_size) {
+                pack(first + k, first + std::min(count, k + slab_size), axis + 1, leaves, nodes);
+            }
+        }
+
+        // volume of the node grown to hold the box and its half-perimeter, which still tells flat boxes apart
+        void grownSize(size_t node, size_t id, double & volume, double & margin) const {
+            double const * bounds = nodeLow(node);
+            volume = 1;
+            margin = 0;
+            for (size_t i = 0; i < _dim; i++) {
+                double extent = std::max(bounds[_dim + i], high(id)[i]) - std::min(bounds[i], low(id)[i]);
+                volume *= extent;
+                margin += extent;
+            }
+        }
+
+        void nodeSize(size_t node, double & volume, double & margin) const {
+            double const * bounds = nodeLow(node);
+            volume = 1;
+            margin = 0;
+            for (size_t i = 0; i < _dim; i++) {
+                volume *= bounds[_dim + i] - bounds[i];
+                margin += bounds[_dim + i] - bounds[i];
+            }
+        }
+
+        size_t chooseChild(size_t node, size_t id) const {
+            size_t best = NONE;
+            double best_growth = 0, best_margin = 0, best_volume = 0;
+            for (auto child : _nodes[node].entries) {
+                double volume, margin, grown_volume, grown_margin;
+                nodeSize(child, volume, margin);
+                grownSize(child, id, grown_volume, grown_margin);
+                double growth = grown_volume - volume, margin_growth = grown_margin - margin;
+                if (best == NONE || growth < best_growth || (growth == best_growth &&
+                        (margin_growth < best_margin || (margin_growth == best_margin && volume < best_volume)))) {
+                    best = child;
+                    best_growth = growth;
+                    best_margin = margin_growth;
+                    best_volume = volume;
+                }
+            }
+            return best;
+        }
+
+        // new sibling of the node when it has been split, NONE otherwise
+        size_t insertInto(size_t node, size_t id) {
+            if (_nodes[node].leaf) {
+                _nodes[node].entries.push_back(id);
+            } else {
+                size_t child = chooseChild(node, id);
+                size_t sibling = insertInto(child, id);
+                if (sibling != NONE) {
+                    _nodes[node].entries.push_back(sibling);
+                }
+            }
+            if (_nodes[node].entries.size() <= NODE_CAPACITY) {
+                updateBounds(node);
+                return NONE;
+            }
+            return split(node);
+        }
+
+        size_t split(size_t node) {
+            bool leaf = _nodes[node].leaf;
+            std::vector<size_t> entries = _nodes[node].entries;
+            size_t axis = 0;
+            double widest = -1;
+            for (size_t i = 0; i < _dim; i++) {
+                double min = INFINITY, max = -INFINITY;
+                for (auto entry : entries) {
+                    min = std::min(min, center(leaf, entry, i));
+                    max = std::max(max, center(leaf, entry, i));
+                }
+                if (max - min > widest) {
+                    widest = max - min;
+                    axis = i;
+                }
+            }
+            sortAlong(entries.begin(), entries.end(), leaf, axis);
+            size_t half = entries.size() / 2;
+            _nodes[node].entries.assign(entries.begin(), entries.begin() + half);
+            updateBounds(node);
+            return makeNode(leaf, std::vector<size_t>(entries.begin() + half, entries.end()));
+        }
+
+        size_t _dim;
+        std::vector<double> _boxes;
+        std::vector<Node> _nodes;
+        std::vector<double> _bounds;
+        size_t _root {NONE};
+    };
+}
+
+#endif /* BOX_TREE_H */
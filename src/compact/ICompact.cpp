@@ -1,5 +1,7 @@
 #include "include/ICompact.h"
+#include "include/ISet.h"
 #include "ICompactImpl.cpp"
+#include "BoxTree.h"
 #include <cmath>
 #include <new>
 #include <algorithm>
@@ -87,6 +89,25 @@ ICompact * ICompact::createCompact(IVector const * begin, IVector const * end, d
     return (ICompact *)result;
 }
 
+ICompact * ICompact::createBoundingBox(ISet const * set, ILogger * logger) {
+    if (set == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return nullptr;
+    }
+    IVector * min = nullptr;
+    IVector * max = nullptr;
+    ReturnCode r_code = set->getBounds(min, max);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+        return nullptr;
+    }
+    // zero accuracy keeps boxes of sets with one element or flat along some axes
+    ICompact * result = createCompact(min, max, 0.0, logger);
+    delete min;
+    delete max;
+    return result;
+}
+
 static bool areCollinear (IVector * vec1, IVector * vec2, double accuracy, size_t & axesNum) {
     size_t numCoords = 0;
     for (int i = 0; i < vec1->getDim(); i++) {
@@ -279,4 +300,43 @@ ICompact * ICompact::convex(ICompact const * comp1, ICompact const * comp2, doub
     delete end1;
     delete end2;
     return resComp;
-}
\ No newline at end of file
+}
+
+ReturnCode ICompact::classify(std::vector<ICompact const *> const & compacts, double const * points, size_t count,
+                              std::vector<size_t> & offsets, std::vector<size_t> & ids, ILogger * logger) {
+    if (compacts.empty() || compacts[0] == nullptr || points == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    size_t dim = compacts[0]->getDim();
+    std::vector<double> corners;
+    corners.reserve(2 * dim * compacts.size());
+    for (auto compact : compacts) {
+        ReturnCode r_code = compact == nullptr ? ReturnCode::RC_NULL_PTR :
+                            compact->getDim() != dim ? ReturnCode::RC_WRONG_DIM : ReturnCode::RC_SUCCESS;
+        if (r_code != ReturnCode::RC_SUCCESS) {
+            LOG(logger, r_code);
+            return r_code;
+        }
+        IVector * begin = compact->getBegin();
+        IVector * end = compact->getEnd();
+        if (!begin || !end) {
+            delete begin;
+            delete end;
+            LOG(logger, ReturnCode::RC_NO_MEM);
+            return ReturnCode::RC_NO_MEM;
+        }
+        for (size_t i = 0; i < dim; i++) {
+            corners.push_back(begin->getCoord(i));
+        }
+        for (size_t i = 0; i < dim; i++) {
+            corners.push_back(end->getCoord(i));
+        }
+        delete begin;
+        delete end;
+    }
+    BoxTree tree(dim);
+    tree.build(corners);
+    tree.classify(points, count, offsets, ids);
+    return ReturnCode::RC_SUCCESS;
+}
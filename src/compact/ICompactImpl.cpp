@@ -1,5 +1,8 @@
 #include "include/ICompact.h"
+#include "Sampling.h"
+#include "Traversal.h"
 #include <cmath>
+#include <cstdint>
 #include <new>
 #include <algorithm>
 #include <assert.h>
@@ -14,140 +17,515 @@ namespace {
         double const _accuracy;
 
     public:
+        // points of the lattice origin + k * step, k counted per axis, so no coordinate accumulates rounding errors
         class IteratorImpl : public ICompact::Iterator {
         private:
-            IVector const * _begin {nullptr};
-            IVector const * _end {nullptr};
-            IVector const * _step {nullptr};
-            IVector * _cur_point {nullptr};
+            size_t _dim {0};
+            // begin for the explicit order and end for the inverse one, step has the sign of the order
+            std::vector<double> _origin;
+            std::vector<double> _step;
+            // point taken after the last one: end for the explicit order and begin for the inverse one
+            std::vector<double> _last;
+            // number of lattice points and the counter of the current point along each axis
+            std::vector<size_t> _counts;
+            std::vector<size_t> _index;
+            std::vector<double> _cur_point;
             std::vector<size_t> _direction;
             SEQUENCE _orientation;
+            // lattice points are numbered in the order of the walk, the iterator walks [_first, _stop)
+            // and _position is the number of the current point
+            size_t _total {0};
+            size_t _first {0};
+            size_t _stop {0};
+            size_t _position {0};
+            bool _done {false};
+            Traversal _traversal {Traversal::LEXICOGRAPHIC};
+            size_t _block {1};
+            // moving direction along each axis in the serpentine order, 1 or -1
+            std::vector<int> _forward;
+            // curve over the counts along the direction axes and the key of the current point in the Hilbert order
+            LatticeHilbert * _hilbert {nullptr};
+            uint64_t _key {0};
             ILogger * _logger {nullptr};
+
+            void setIndex(size_t axis, size_t index);
+            void locate(size_t position);
+            void renumber();
+            ReturnCode buildHilbert();
+            bool advance();
+            void stepLexicographic();
+            void stepSerpentine();
+            void stepBlocked();
+            void stepHilbert();
         public:
             ReturnCode setDirection(std::vector<size_t> const & direction)  override;
+            ReturnCode setTraversal(Traversal traversal, size_t blockSize)  override;
+            Traversal getTraversal()                                  const override;
             ReturnCode doStep()                                             override;
             IVector * getPoint()                                      const override;
+            ReturnCode getPoint(double * point)                       const override;
+            size_t getPoints(double * points, size_t maxCount)              override;
+            size_t getDim()                                           const override;
+            size_t getCount()                                         const override;
+            size_t getPosition()                                      const override;
+            ReturnCode seek(size_t position)                                override;
+            ReturnCode split(size_t parts, std::vector<Iterator *> & iterators) const override;
 
-            IteratorImpl(IVector const * beg, IVector const * end, IVector const * step, std::vector<size_t> const & dir, SEQUENCE orientation);
+            IteratorImpl(std::vector<double> const & begin, std::vector<double> const & end, std::vector<double> const & step,
+                         std::vector<size_t> const & direction, SEQUENCE orientation);
             ~IteratorImpl();
         };
 
         Iterator * begin(IVector const * step)                            override;
+        ReturnCode getGridSize(IVector const * step, size_t & count)                                      const override;
+        ReturnCode getGridShape(IVector const * step, std::vector<size_t> & counts)                       const override;
+        ReturnCode generateGrid(IVector const * step, std::vector<size_t> const & direction, double * points, size_t count,
+                                Traversal traversal, size_t blockSize) const override;
+        ReturnCode generateGrid(IVector const * step, std::vector<size_t> const & direction, std::vector<double> & points,
+                                Traversal traversal, size_t blockSize) const override;
+        ReturnCode generateSamples(Sampling method, uint64_t seed, size_t total, size_t first, double * points, size_t count) const override;
+        ReturnCode generateSamples(Sampling method, uint64_t seed, size_t count, std::vector<double> & points) const override;
         Iterator * end(IVector const * step)                              override;
         ICompact * clone()                                          const override;
         IVector * getBegin()                                        const override;
         IVector * getEnd()                                          const override;
         ReturnCode contains(IVector const * vec, bool & result)     const override;
+        ReturnCode containsBatch(double const * points, size_t count, uint8_t * mask) const override;
         ReturnCode isSubset(ICompact const * anotherCopm, bool & result)   const override;
         ReturnCode intersects(ICompact const * anotherCopm, bool & result) const override;
         size_t getDim() const override;
 
         ICompactImpl(IVector const * begin, IVector const * end, double accuracy);
         ~ICompactImpl();
+
+    private:
+        ReturnCode gridCounts(IVector const * step, std::vector<double> & steps, std::vector<size_t> & counts, size_t & count) const;
     };
 }
 
-ICompactImpl::IteratorImpl::IteratorImpl(IVector const * begin,
-                                         IVector const * end,
-                                         IVector const * step,
+// number of points origin + k * step within [begin, end], step is negative for origin at end;
+// counts too large to be ever walked through are cut to 2^62 or, for 32-bit size_t, to 2^31 - 1, so they fit size_t
+static size_t latticeCount(double origin, double step, double begin, double end) {
+    double const limit = std::min(4611686018427387904.0, (double)(SIZE_MAX >> 1));
+    double count = std::min(limit, std::floor((end - begin) / std::fabs(step)) + 1);
+    // division rounding is corrected by the exact test of the last point
+    while (count > 1 && (origin + (count - 1) * step > end || origin + (count - 1) * step < begin)) {
+        count--;
+    }
+    while (count < limit && origin + count * step <= end && origin + count * step >= begin) {
+        count++;
+    }
+    return (size_t)count;
+}
+
+static ReturnCode checkDirection(std::vector<size_t> const & direction, size_t dim, ILogger * logger) {
+    if (direction.size() != dim) {
+        LOG(logger, ReturnCode::RC_WRONG_DIM);
+        return ReturnCode::RC_WRONG_DIM;
+    }
+    std::vector<bool> bool_vec(direction.size(), false);
+    for (auto dir : direction) {
+        if (dir >= dim || bool_vec[dir]) {
+            LOG(logger, ReturnCode::RC_INVALID_PARAMS);
+            return ReturnCode::RC_INVALID_PARAMS;
+        }
+        bool_vec[dir] = true;
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ICompactImpl::IteratorImpl::IteratorImpl(std::vector<double> const & begin,
+                                         std::vector<double> const & end,
+                                         std::vector<double> const & step,
                                          std::vector<size_t> const & direction,
                                          SEQUENCE orientation) :
-        _begin(begin),
-        _end(end),
+        _dim(begin.size()),
+        _origin(orientation == EXPLICIT ? begin : end),
         _step(step),
+        _last(orientation == EXPLICIT ? end : begin),
+        _counts(begin.size()),
+        _index(begin.size(), 0),
+        _cur_point(_origin),
         _direction(direction),
-        _orientation(orientation) {
-    if (_orientation == EXPLICIT) {
-        _cur_point = begin->clone();
-    } else {
-        _cur_point = end->clone();
-    }
+        _orientation(orientation),
+        _forward(begin.size(), 1) {
+    // the number of points saturates, the walk over such a lattice never gets to its end anyway
+    _total = 1;
+    for (size_t i = 0; i < _dim; i++) {
+        _step[i] *= orientation;
+        _counts[i] = latticeCount(_origin[i], _step[i], begin[i], end[i]);
+        _total = _total > SIZE_MAX / _counts[i] ? SIZE_MAX : _total * _counts[i];
+    }
+    _stop = _total;
     _logger = ILogger::createLogger(this);
 }
 
 ICompactImpl::IteratorImpl::~IteratorImpl() {
-    if (_begin != nullptr) {
-        delete _begin;
-        _begin = nullptr;
-    }
-    if (_end != nullptr) {
-        delete _end;
-        _end = nullptr;
-    }
-    if (_cur_point!= nullptr) {
-        delete _cur_point;
-        _cur_point = nullptr;
-    }
-    if (_step != nullptr) {
-        delete _step;
-        _step = nullptr;
-    }
+    delete _hilbert;
+    _hilbert = nullptr;
     if (_logger != nullptr) {
         _logger->releaseLogger(this);
     }
 }
 
+// the range of a split iterator is bound to the order of the walk, so its direction is fixed
 ReturnCode ICompactImpl::IteratorImpl::setDirection(std::vector<size_t> const & direction) {
-    if (direction.size() != _begin->getDim()) {
-        LOG(_logger, ReturnCode::RC_WRONG_DIM);
+    ReturnCode r_code = checkDirection(direction, _dim, _logger);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
     }
-    std::vector<bool> bool_vec(direction.size(), false);
-    for (auto dir : direction) {
-        bool_vec[dir] = true;
+    if (_first != 0 || _stop != _total) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
     }
-    bool have_all_dirs = true;
-    for (auto exist_axis : bool_vec) {
-        if (!exist_axis) {
-            have_all_dirs = false;
-            break;
-        }
+    std::vector<size_t> old_direction(_direction);
+    _direction = direction;
+    if ((r_code = buildHilbert()) != ReturnCode::RC_SUCCESS) {
+        _direction = old_direction;
+        buildHilbert();
+        return r_code;
     }
-    if (!have_all_dirs) {
+    renumber();
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactImpl::IteratorImpl::setTraversal(Traversal traversal, size_t blockSize) {
+    if (_first != 0 || _stop != _total || (traversal == Traversal::BLOCKED && blockSize == 0) ||
+            (traversal != Traversal::LEXICOGRAPHIC && _total == SIZE_MAX)) {
         LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    Traversal old_traversal = _traversal;
+    _traversal = traversal;
+    ReturnCode r_code = buildHilbert();
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        _traversal = old_traversal;
+        buildHilbert();
+        return r_code;
+    }
+    _block = traversal == Traversal::BLOCKED ? blockSize : 1;
+    renumber();
+    return ReturnCode::RC_SUCCESS;
+}
+
+ICompact::Traversal ICompactImpl::IteratorImpl::getTraversal() const {
+    return _traversal;
+}
+
+ReturnCode ICompactImpl::IteratorImpl::buildHilbert() {
+    delete _hilbert;
+    _hilbert = nullptr;
+    if (_traversal != Traversal::HILBERT) {
+        return ReturnCode::RC_SUCCESS;
+    }
+    std::vector<size_t> counts(_dim);
+    for (size_t a = 0; a < _dim; a++) {
+        counts[a] = _counts[_direction[a]];
+    }
+    _hilbert = new(std::nothrow) LatticeHilbert(counts);
+    if (_hilbert == nullptr) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    if (!_hilbert->supported()) {
+        delete _hilbert;
+        _hilbert = nullptr;
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
     }
-    _direction = direction;
     return ReturnCode::RC_SUCCESS;
 }
 
-ReturnCode ICompactImpl::IteratorImpl::doStep() {
-    size_t cur_axis = 0;
-    double new_value;
-    for (cur_axis = 0; cur_axis < _begin->getDim();) {
-        size_t d = _direction[cur_axis];
-        new_value = _cur_point->getCoord(d) + _orientation * _step->getCoord(d);
-        if (_orientation == INVERSE && new_value < _begin->getCoord(d)) {
-            _cur_point->setCoord(d, _end->getCoord(d));
-            cur_axis++;
+void ICompactImpl::IteratorImpl::setIndex(size_t axis, size_t index) {
+    _index[axis] = index;
+    _cur_point[axis] = _origin[axis] + index * _step[axis];
+}
+
+// number of the current point in the order of the walk; the point stays when the order changes
+void ICompactImpl::IteratorImpl::renumber() {
+    size_t position = 0;
+    switch (_traversal) {
+        case Traversal::LEXICOGRAPHIC:
+        case Traversal::SERPENTINE: {
+            // a serpentine axis goes backwards when the counters of the slower axes sum to an odd number
+            size_t stride = 1, parity = 0;
+            for (size_t a = _dim; a-- > 0;) {
+                size_t d = _direction[a];
+                bool reversed = _traversal == Traversal::SERPENTINE && parity % 2 == 1;
+                _forward[d] = reversed ? -1 : 1;
+                parity += _index[d];
+            }
+            for (auto d : _direction) {
+                position += (_forward[d] < 0 ? _counts[d] - 1 - _index[d] : _index[d]) * stride;
+                stride = saturatingMul(stride, _counts[d]);
+            }
+            break;
         }
-        else if (_orientation == EXPLICIT && new_value > _end->getCoord(d)) {
-            _cur_point->setCoord(d, _begin->getCoord(d));
-            cur_axis++;
+        case Traversal::BLOCKED: {
+            // tiles before the current one along a slower axis are full
+            size_t lower = _total, tile_points = 1;
+            for (size_t a = _dim; a-- > 0;) {
+                size_t d = _direction[a];
+                lower /= _counts[d];
+                size_t tile = _index[d] / _block;
+                position += tile * _block * tile_points * lower;
+                tile_points *= std::min(_block, _counts[d] - tile * _block);
+            }
+            size_t stride = 1;
+            for (auto d : _direction) {
+                size_t tile = _index[d] / _block;
+                position += (_index[d] - tile * _block) * stride;
+                stride *= std::min(_block, _counts[d] - tile * _block);
+            }
+            break;
         }
-        else {
-            _cur_point->setCoord(d, new_value);
+        case Traversal::HILBERT: {
+            uint64_t coords[LatticeHilbert::MAX_AXES];
+            for (size_t a = 0; a < _dim; a++) {
+                coords[a] = _index[_direction[a]];
+            }
+            _key = _hilbert->encode(coords);
+            position = _hilbert->rank(_key);
+            break;
+        }
+    }
+    _position = position;
+}
+
+// counters of the point with the given number in the order of the walk
+void ICompactImpl::IteratorImpl::locate(size_t position) {
+    _position = position;
+    _done = false;
+    switch (_traversal) {
+        case Traversal::LEXICOGRAPHIC:
+        case Traversal::SERPENTINE:
+            // axes of the direction are digits of the number from the lowest one
+            for (auto d : _direction) {
+                setIndex(d, position % _counts[d]);
+                position /= _counts[d];
+            }
+            if (_traversal == Traversal::SERPENTINE) {
+                size_t parity = 0;
+                for (size_t a = _dim; a-- > 0;) {
+                    size_t d = _direction[a];
+                    _forward[d] = parity % 2 == 1 ? -1 : 1;
+                    if (_forward[d] < 0) {
+                        setIndex(d, _counts[d] - 1 - _index[d]);
+                    }
+                    parity += _index[d];
+                }
+            }
+            break;
+        case Traversal::BLOCKED: {
+            size_t lower = _total, tile_points = 1;
+            std::vector<size_t> sizes(_dim);
+            for (size_t a = _dim; a-- > 0;) {
+                size_t d = _direction[a];
+                lower /= _counts[d];
+                size_t slab = _block * tile_points * lower;
+                size_t tile = position / slab;
+                position -= tile * slab;
+                _index[d] = tile * _block;
+                sizes[a] = std::min(_block, _counts[d] - tile * _block);
+                tile_points *= sizes[a];
+            }
+            for (size_t a = 0; a < _dim; a++) {
+                size_t d = _direction[a];
+                setIndex(d, _index[d] + position % sizes[a]);
+                position /= sizes[a];
+            }
             break;
         }
+        case Traversal::HILBERT: {
+            _key = _hilbert->select(position);
+            uint64_t coords[LatticeHilbert::MAX_AXES];
+            _hilbert->decode(_key, coords);
+            for (size_t a = 0; a < _dim; a++) {
+                setIndex(_direction[a], (size_t)coords[a]);
+            }
+            break;
+        }
+    }
+}
+
+// false after the last point of the range, the iterator stays at the point after it
+bool ICompactImpl::IteratorImpl::advance() {
+    if (_done || _position + 1 >= _stop) {
+        _done = true;
+        _cur_point = _last;
+        return false;
+    }
+    _position++;
+    switch (_traversal) {
+        case Traversal::LEXICOGRAPHIC:
+            stepLexicographic();
+            break;
+        case Traversal::SERPENTINE:
+            stepSerpentine();
+            break;
+        case Traversal::BLOCKED:
+            stepBlocked();
+            break;
+        case Traversal::HILBERT:
+            stepHilbert();
+            break;
+    }
+    return true;
+}
+
+void ICompactImpl::IteratorImpl::stepLexicographic() {
+    for (auto d : _direction) {
+        if (_index[d] + 1 < _counts[d]) {
+            setIndex(d, _index[d] + 1);
+            return;
+        }
+        setIndex(d, 0);
     }
+}
 
-    if (cur_axis < _begin->getDim()) {
+// an axis at its end stays and turns back, so consecutive points differ along one axis by one step
+void ICompactImpl::IteratorImpl::stepSerpentine() {
+    for (auto d : _direction) {
+        size_t next = _index[d] + _forward[d];
+        if (next < _counts[d]) {
+            setIndex(d, next);
+            return;
+        }
+        _forward[d] = -_forward[d];
+    }
+}
+
+// points of a tile go in the lexicographic order, then the next tile starts at its first point
+void ICompactImpl::IteratorImpl::stepBlocked() {
+    for (auto d : _direction) {
+        size_t tile_begin = _index[d] / _block * _block;
+        if (_index[d] + 1 < std::min(tile_begin + _block, _counts[d])) {
+            setIndex(d, _index[d] + 1);
+            return;
+        }
+        setIndex(d, tile_begin);
+    }
+    for (auto d : _direction) {
+        if (_index[d] + _block < _counts[d]) {
+            setIndex(d, _index[d] + _block);
+            return;
+        }
+        setIndex(d, 0);
+    }
+}
+
+// the next key on the curve is usually inside the lattice, otherwise the next lattice point is searched for
+void ICompactImpl::IteratorImpl::stepHilbert() {
+    uint64_t coords[LatticeHilbert::MAX_AXES];
+    _hilbert->decode(_key + 1, coords);
+    if (_hilbert->inside(coords)) {
+        _key++;
+    } else {
+        _key = _hilbert->select(_position);
+        _hilbert->decode(_key, coords);
+    }
+    for (size_t a = 0; a < _dim; a++) {
+        setIndex(_direction[a], (size_t)coords[a]);
+    }
+}
+
+ReturnCode ICompactImpl::IteratorImpl::doStep() {
+    if (advance()) {
         return ReturnCode::RC_SUCCESS;
     }
-    if (cur_axis >= _begin->getDim()) {
+    LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
+    return ReturnCode::RC_OUT_OF_BOUNDS;
+}
+
+size_t ICompactImpl::IteratorImpl::getPoints(double * points, size_t maxCount) {
+    if (points == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return 0;
+    }
+    size_t count = 0;
+    while (count < maxCount && !_done) {
+        std::copy(_cur_point.begin(), _cur_point.end(), points + count * _dim);
+        count++;
+        advance();
+    }
+    return count;
+}
+
+size_t ICompactImpl::IteratorImpl::getCount() const {
+    return _stop - _first;
+}
+
+size_t ICompactImpl::IteratorImpl::getPosition() const {
+    return _position - _first;
+}
+
+ReturnCode ICompactImpl::IteratorImpl::seek(size_t position) {
+    if (position >= _stop - _first) {
         LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
-        delete _cur_point;
-        _cur_point = nullptr;
-        if (_orientation == EXPLICIT) {
-            _cur_point = _end->clone();
-        } else {
-            _cur_point = _begin->clone();
-        }
         return ReturnCode::RC_OUT_OF_BOUNDS;
     }
+    locate(_first + position);
+    return ReturnCode::RC_SUCCESS;
+}
+
+// parts get ranges differing in size by at most one point, each part starts at its first point
+ReturnCode ICompactImpl::IteratorImpl::split(size_t parts, std::vector<Iterator *> & iterators) const {
+    iterators.clear();
+    size_t count = _stop - _first;
+    if (parts == 0 || parts > count) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    std::vector<double> begin(_orientation == EXPLICIT ? _origin : _last);
+    std::vector<double> end(_orientation == EXPLICIT ? _last : _origin);
+    std::vector<double> step(_dim);
+    for (size_t i = 0; i < _dim; i++) {
+        step[i] = std::fabs(_step[i]);
+    }
+    for (size_t k = 0; k < parts; k++) {
+        IteratorImpl * part = new(std::nothrow) IteratorImpl(begin, end, step, _direction, _orientation);
+        if (part == nullptr) {
+            for (auto iterator : iterators) {
+                delete iterator;
+            }
+            iterators.clear();
+            LOG(_logger, ReturnCode::RC_NO_MEM);
+            return ReturnCode::RC_NO_MEM;
+        }
+        part->_traversal = _traversal;
+        part->_block = _block;
+        if (part->buildHilbert() != ReturnCode::RC_SUCCESS) {
+            delete part;
+            for (auto iterator : iterators) {
+                delete iterator;
+            }
+            iterators.clear();
+            return ReturnCode::RC_NO_MEM;
+        }
+        // count / parts * k + count % parts * k / parts without overflow
+        part->_first = _first + count / parts * k + count % parts * k / parts;
+        part->_stop = _first + count / parts * (k + 1) + count % parts * (k + 1) / parts;
+        part->locate(part->_first);
+        iterators.push_back(part);
+    }
     return ReturnCode::RC_SUCCESS;
 }
 
 IVector * ICompactImpl::IteratorImpl::getPoint() const {
-    return _cur_point->clone();
+    return IVector::createVector(_dim, const_cast<double *>(_cur_point.data()), _logger);
+}
+
+ReturnCode ICompactImpl::IteratorImpl::getPoint(double * point) const {
+    if (point == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    std::copy(_cur_point.begin(), _cur_point.end(), point);
+    return ReturnCode::RC_SUCCESS;
+}
+
+size_t ICompactImpl::IteratorImpl::getDim() const {
+    return _dim;
 }
 
 static ReturnCode checkStep(IVector const * step, size_t dim, ILogger * logger) {
@@ -157,7 +535,7 @@ static ReturnCode checkStep(IVector const * step, size_t dim, ILogger * logger)
     }
 
     for (size_t i = 0; i < dim; i++) {
-        if (step->getCoord(i) <= 0.0) {
+        if (!(step->getCoord(i) > 0.0)) {
             LOG(logger, ReturnCode::RC_INVALID_PARAMS);
             return ReturnCode::RC_INVALID_PARAMS;
         }
@@ -171,41 +549,22 @@ static ICompact::Iterator * createIterator(IVector const * _begin, IVector const
         LOG(logger, ReturnCode::RC_NULL_PTR);
         return nullptr;
     }
-
-    IVector const * begin = _begin->clone();
-    IVector const * end   = _end->clone();
-    if (begin == nullptr) {
-        LOG(logger, ReturnCode::RC_NULL_PTR);
-        delete begin;
-        return nullptr;
-    }
-    if (end == nullptr) {
-        LOG(logger, ReturnCode::RC_NULL_PTR);
-        delete end;
+    if (checkStep(_step, _begin->getDim(), logger) != ReturnCode::RC_SUCCESS) {
         return nullptr;
     }
 
-    IVector * step;
-    if (checkStep(_step, _begin->getDim(), logger) == ReturnCode::RC_SUCCESS) {
-        step = _step->clone();
-        if (step == nullptr) {
-            delete begin;
-            delete end;
-            return nullptr;
-        }
-    } else {
-        return nullptr;
-    }
-
-    std::vector<size_t> direction(begin->getDim());
-    for (size_t cur_axis = 0; cur_axis < begin->getDim(); cur_axis++) {
+    size_t dim = _begin->getDim();
+    std::vector<double> begin(dim), end(dim), step(dim);
+    std::vector<size_t> direction(dim);
+    for (size_t cur_axis = 0; cur_axis < dim; cur_axis++) {
+        begin[cur_axis] = _begin->getCoord(cur_axis);
+        end[cur_axis] = _end->getCoord(cur_axis);
+        step[cur_axis] = _step->getCoord(cur_axis);
         direction[cur_axis] = cur_axis;
     }
     ICompact::Iterator * iterator = new(std::nothrow) ICompactImpl::IteratorImpl(begin, end, step, direction, orientation);
     if (iterator == nullptr) {
-        delete begin;
-        delete end;
-        delete step;
+        LOG(logger, ReturnCode::RC_NO_MEM);
     }
     return iterator;
 }
@@ -219,6 +578,238 @@ ICompact::Iterator * ICompactImpl::end(IVector const * step) {
     return createIterator(_begin, _end, step, INVERSE, _logger);
 }
 
+// lattice points along every axis and in total, RC_OUT_OF_BOUNDS if the total does not fit size_t
+ReturnCode ICompactImpl::gridCounts(IVector const * step, std::vector<double> & steps, std::vector<size_t> & counts, size_t & count) const {
+    if (step == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    ReturnCode r_code = checkStep(step, _dim, _logger);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    steps.resize(_dim);
+    counts.resize(_dim);
+    count = 1;
+    for (size_t i = 0; i < _dim; i++) {
+        steps[i] = step->getCoord(i);
+        counts[i] = latticeCount(_begin->getCoord(i), steps[i], _begin->getCoord(i), _end->getCoord(i));
+        if (count > SIZE_MAX / counts[i]) {
+            LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
+            return ReturnCode::RC_OUT_OF_BOUNDS;
+        }
+        count *= counts[i];
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactImpl::getGridSize(IVector const * step, size_t & count) const {
+    std::vector<double> steps;
+    std::vector<size_t> counts;
+    return gridCounts(step, steps, counts, count);
+}
+
+ReturnCode ICompactImpl::getGridShape(IVector const * step, std::vector<size_t> & counts) const {
+    std::vector<double> steps;
+    size_t count;
+    return gridCounts(step, steps, counts, count);
+}
+
+// every coordinate is written column by column: along axis direction[a] a value is repeated
+// for the block of points that only differ along the faster axes direction[0..a-1];
+// other orders are written by an iterator
+ReturnCode ICompactImpl::generateGrid(IVector const * step, std::vector<size_t> const & direction, double * points, size_t count,
+                                      Traversal traversal, size_t blockSize) const {
+    if (points == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    std::vector<double> steps;
+    std::vector<size_t> counts;
+    size_t grid_size;
+    ReturnCode r_code = gridCounts(step, steps, counts, grid_size);
+    if (r_code != ReturnCode::RC_SUCCESS || (r_code = checkDirection(direction, _dim, _logger)) != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    if (count < grid_size) {
+        LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
+        return ReturnCode::RC_OUT_OF_BOUNDS;
+    }
+    if (traversal != Traversal::LEXICOGRAPHIC) {
+        std::vector<double> begin(_dim), end(_dim);
+        for (size_t i = 0; i < _dim; i++) {
+            begin[i] = _begin->getCoord(i);
+            end[i] = _end->getCoord(i);
+        }
+        IteratorImpl iterator(begin, end, steps, direction, EXPLICIT);
+        if ((r_code = iterator.setTraversal(traversal, blockSize)) != ReturnCode::RC_SUCCESS) {
+            LOG(_logger, r_code);
+            return r_code;
+        }
+        iterator.getPoints(points, grid_size);
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    size_t block = 1;
+    for (auto d : direction) {
+        double origin = _begin->getCoord(d);
+        double * cur = points + d;
+        for (size_t done = 0; done < grid_size; ) {
+            for (size_t k = 0; k < counts[d]; k++) {
+                double value = origin + k * steps[d];
+                for (size_t p = 0; p < block; p++, cur += _dim) {
+                    *cur = value;
+                }
+            }
+            done += block * counts[d];
+        }
+        block *= counts[d];
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactImpl::generateGrid(IVector const * step, std::vector<size_t> const & direction, std::vector<double> & points,
+                                      Traversal traversal, size_t blockSize) const {
+    size_t count;
+    ReturnCode r_code = getGridSize(step, count);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    if (count > points.max_size() / _dim) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    points.resize(count * _dim);
+    return generateGrid(step, direction, points.data(), count, traversal, blockSize);
+}
+
+// fractions of the samples in [0, 1) first, then scaled to the box in place
+ReturnCode ICompactImpl::generateSamples(Sampling method, uint64_t seed, size_t total, size_t first, double * points, size_t count) const {
+    if (points == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    if (first > total || count > total - first) {
+        LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
+        return ReturnCode::RC_OUT_OF_BOUNDS;
+    }
+    if (method == Sampling::SOBOL && (_dim > SobolSequence::MAX_AXES || (uint64_t)total > (1ULL << SobolSequence::BITS))) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    if (count == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    switch (method) {
+        case Sampling::SOBOL: {
+            SobolSequence sobol(_dim);
+            std::vector<uint32_t> x(_dim), shift(_dim, 0);
+            if (seed != 0) {
+                for (size_t j = 0; j < _dim; j++) {
+                    shift[j] = (uint32_t)mixBits(seed, j, 0);
+                }
+            }
+            sobol.point(first, x.data());
+            for (size_t k = 0; k < count; k++) {
+                if (k > 0) {
+                    sobol.next(first + k - 1, x.data());
+                }
+                for (size_t j = 0; j < _dim; j++) {
+                    points[k * _dim + j] = (x[j] ^ shift[j]) * (1.0 / 4294967296.0);
+                }
+            }
+            break;
+        }
+        case Sampling::HALTON: {
+            // a random rotation of the unit cube along every axis
+            std::vector<uint64_t> primes = firstPrimes(_dim);
+            std::vector<double> shift(_dim, 0);
+            if (seed != 0) {
+                for (size_t j = 0; j < _dim; j++) {
+                    shift[j] = unitDouble(mixBits(seed, j, 0));
+                }
+            }
+            for (size_t k = 0; k < count; k++) {
+                for (size_t j = 0; j < _dim; j++) {
+                    double value = radicalInverse(first + k, primes[j]) + shift[j];
+                    points[k * _dim + j] = value >= 1 ? value - 1 : value;
+                }
+            }
+            break;
+        }
+        case Sampling::LATIN_HYPERCUBE: {
+            // slices of the samples along every axis are a random permutation of them
+            std::vector<IndexPermutation> slices;
+            for (size_t j = 0; j < _dim; j++) {
+                slices.push_back(IndexPermutation(total, mixBits(seed, j, total)));
+            }
+            for (size_t k = 0; k < count; k++) {
+                for (size_t j = 0; j < _dim; j++) {
+                    double slice = (double)slices[j](first + k);
+                    points[k * _dim + j] = (slice + unitDouble(mixBits(seed, j, first + k + 1))) / total;
+                }
+            }
+            break;
+        }
+        case Sampling::STRATIFIED: {
+            // the largest side with side^dim cells not above total
+            size_t side = std::max<size_t>(1, (size_t)std::pow((double)total, 1.0 / _dim));
+            auto fits = [this, total](size_t side) {
+                size_t cells = 1;
+                for (size_t j = 0; j < _dim; j++) {
+                    if (cells > total / side) {
+                        return false;
+                    }
+                    cells *= side;
+                }
+                return true;
+            };
+            while (side > 1 && !fits(side)) {
+                side--;
+            }
+            while (fits(side + 1)) {
+                side++;
+            }
+            size_t cells = 1;
+            for (size_t j = 0; j < _dim; j++) {
+                cells *= side;
+            }
+            for (size_t k = 0; k < count; k++) {
+                size_t cell = (first + k) % cells;
+                for (size_t j = 0; j < _dim; j++) {
+                    double offset = (double)(cell % side) + unitDouble(mixBits(seed, j, first + k + 1));
+                    points[k * _dim + j] = offset / side;
+                    cell /= side;
+                }
+            }
+            break;
+        }
+    }
+
+    std::vector<double> begin(_dim), size(_dim);
+    for (size_t j = 0; j < _dim; j++) {
+        begin[j] = _begin->getCoord(j);
+        size[j] = _end->getCoord(j) - begin[j];
+    }
+    for (size_t k = 0; k < count; k++) {
+        double * cur = points + k * _dim;
+        for (size_t j = 0; j < _dim; j++) {
+            cur[j] = begin[j] + cur[j] * size[j];
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactImpl::generateSamples(Sampling method, uint64_t seed, size_t count, std::vector<double> & points) const {
+    if (count > points.max_size() / _dim) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    points.resize(count * _dim);
+    return generateSamples(method, seed, count, 0, points.data(), count);
+}
+
 ICompact* ICompactImpl::clone() const {
     return ICompact::createCompact(_begin, _end, _accuracy, _logger);
 }
@@ -249,6 +840,35 @@ ReturnCode ICompactImpl::contains(IVector const * vec, bool & result) const {
     result = true;
     return ReturnCode::RC_SUCCESS;
 }
+
+// bounds are read once; points go in blocks that stay in cache while every axis is compared for all of them
+// in a branchless loop the compiler vectorizes
+ReturnCode ICompactImpl::containsBatch(double const * points, size_t count, uint8_t * mask) const {
+    if (points == nullptr || mask == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    std::vector<double> low(_dim), high(_dim);
+    for (size_t i = 0; i < _dim; i++) {
+        low[i] = _begin->getCoord(i);
+        high[i] = _end->getCoord(i);
+    }
+    size_t const block = 1024;
+    std::fill(mask, mask + count, 1);
+    for (size_t first = 0; first < count; first += block) {
+        size_t last = std::min(count, first + block);
+        for (size_t i = 0; i < _dim; i++) {
+            double const lo = low[i], hi = high[i];
+            double const * cur = points + i;
+            for (size_t k = first; k < last; k++) {
+                double coord = cur[k * _dim];
+                mask[k] &= (uint8_t)((coord >= lo) & (coord <= hi));
+            }
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
 static ReturnCode checkComp(ICompact const * anotherCopm, size_t dim, ILogger * logger) {
     if (anotherCopm == nullptr) {
         LOG(logger, ReturnCode::RC_NULL_PTR);
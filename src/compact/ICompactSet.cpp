@@ -0,0 +1,137 @@
+#include "include/ICompactSet.h"
+#include "ICompactSetImpl.cpp"
+#include <cmath>
+#include <new>
+#include <vector>
+
+ICompactSet::~ICompactSet() {}
+
+ICompactSet * ICompactSet::createCompactSet(size_t dim, double tolerance, ILogger * logger) {
+    if (dim == 0) {
+        LOG(logger, ReturnCode::RC_ZERO_DIM);
+        return nullptr;
+    }
+    if (std::isnan(tolerance) || tolerance < 0.0) {
+        LOG(logger, ReturnCode::RC_INVALID_PARAMS);
+        return nullptr;
+    }
+    ICompactSetImpl * result = new(std::nothrow) ICompactSetImpl(dim, tolerance);
+    if (!result) {
+        LOG(logger, ReturnCode::RC_NO_MEM);
+    }
+    return result;
+}
+
+ICompactSet * ICompactSet::createCompactSet(std::vector<ICompact const *> const & boxes, double tolerance, ILogger * logger) {
+    if (boxes.empty() || boxes[0] == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return nullptr;
+    }
+    ICompactSetImpl * result = (ICompactSetImpl *)createCompactSet(boxes[0]->getDim(), tolerance, logger);
+    if (!result) {
+        return nullptr;
+    }
+    std::vector<double> all, corners;
+    for (auto box : boxes) {
+        if (result->readStoredBox(box, corners) != ReturnCode::RC_SUCCESS) {
+            LOG(logger, ReturnCode::RC_INVALID_PARAMS);
+            delete result;
+            return nullptr;
+        }
+        all.insert(all.end(), corners.begin(), corners.end());
+    }
+    result->build(all);
+    return result;
+}
+
+// the result takes the tolerance of the first set
+static ICompactSetImpl * emptyResult(ICompactSet const * set1, ICompactSet const * set2, ILogger * logger) {
+    if (!set1 || !set2) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return nullptr;
+    }
+    if (set1->getDim() != set2->getDim()) {
+        LOG(logger, ReturnCode::RC_WRONG_DIM);
+        return nullptr;
+    }
+    double tolerance = static_cast<ICompactSetImpl const *>(set1)->getTolerance();
+    return (ICompactSetImpl *)ICompactSet::createCompactSet(set1->getDim(), tolerance, logger);
+}
+
+ICompactSet * ICompactSet::_union(ICompactSet const * set1, ICompactSet const * set2, ILogger * logger) {
+    ICompactSetImpl * result = emptyResult(set1, set2, logger);
+    if (!result) {
+        return nullptr;
+    }
+    BoxTree const & tree1 = static_cast<ICompactSetImpl const *>(set1)->getTree();
+    BoxTree const & tree2 = static_cast<ICompactSetImpl const *>(set2)->getTree();
+    std::vector<double> all(tree1.boxes());
+    all.insert(all.end(), tree2.boxes().begin(), tree2.boxes().end());
+    result->build(all);
+    return result;
+}
+
+// overlaps of the boxes of set1 with the boxes of set2 found in its tree, boxes touching by a boundary only give nothing
+ICompactSet * ICompactSet::intersection(ICompactSet const * set1, ICompactSet const * set2, ILogger * logger) {
+    ICompactSetImpl * result = emptyResult(set1, set2, logger);
+    if (!result) {
+        return nullptr;
+    }
+    BoxTree const & tree1 = static_cast<ICompactSetImpl const *>(set1)->getTree();
+    BoxTree const & tree2 = static_cast<ICompactSetImpl const *>(set2)->getTree();
+    size_t dim = tree1.getDim();
+    double tolerance = result->getTolerance();
+    std::vector<double> all, overlap(2 * dim);
+    for (size_t id = 0; id < tree1.size(); id++) {
+        tree2.search(tree1.low(id), tree1.high(id), [&](size_t other) {
+            if (!boxesOverlap(tree1.low(id), tree1.high(id), tree2.low(other), tree2.high(other), dim) ||
+                    !boxesOverlap(tree2.low(other), tree2.high(other), tree1.low(id), tree1.high(id), dim)) {
+                return false;
+            }
+            bool thin = false;
+            for (size_t i = 0; i < dim; i++) {
+                overlap[i] = std::max(tree1.low(id)[i], tree2.low(other)[i]);
+                overlap[dim + i] = std::min(tree1.high(id)[i], tree2.high(other)[i]);
+                thin = thin || overlap[dim + i] - overlap[i] < tolerance;
+            }
+            if (!thin) {
+                all.insert(all.end(), overlap.begin(), overlap.end());
+            }
+            return false;
+        });
+    }
+    result->build(all);
+    return result;
+}
+
+// every box of set1 is cut by the boxes of set2 meeting it
+ICompactSet * ICompactSet::difference(ICompactSet const * set1, ICompactSet const * set2, ILogger * logger) {
+    ICompactSetImpl * result = emptyResult(set1, set2, logger);
+    if (!result) {
+        return nullptr;
+    }
+    BoxTree const & tree1 = static_cast<ICompactSetImpl const *>(set1)->getTree();
+    BoxTree const & tree2 = static_cast<ICompactSetImpl const *>(set2)->getTree();
+    size_t dim = tree1.getDim();
+    double tolerance = result->getTolerance();
+    std::vector<double> all, pieces, rest;
+    std::vector<size_t> cuts;
+    for (size_t id = 0; id < tree1.size(); id++) {
+        cuts.clear();
+        tree2.search(tree1.low(id), tree1.high(id), [&cuts](size_t other) {
+            cuts.push_back(other);
+            return false;
+        });
+        pieces.assign(tree1.low(id), tree1.low(id) + 2 * dim);
+        for (size_t k = 0; k < cuts.size() && !pieces.empty(); k++) {
+            rest.clear();
+            for (size_t p = 0; p < pieces.size(); p += 2 * dim) {
+                subtractBox(pieces.data() + p, pieces.data() + p + dim, tree2.low(cuts[k]), tree2.high(cuts[k]), dim, tolerance, rest);
+            }
+            pieces.swap(rest);
+        }
+        all.insert(all.end(), pieces.begin(), pieces.end());
+    }
+    result->build(all);
+    return result;
+}
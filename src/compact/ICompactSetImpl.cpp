@@ -0,0 +1,271 @@
+#include "include/ICompactSet.h"
+#include "BoxTree.h"
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <vector>
+
+namespace {
+    class ICompactSetImpl : public ICompactSet {
+    private:
+        BoxTree _tree;
+        double _tolerance;
+        ILogger * _logger {nullptr};
+
+    public:
+        ReturnCode insert(ICompact const * box)                            override;
+        size_t getDim()                                              const override;
+        size_t getSize()                                             const override;
+        ICompact * getBox(size_t index)                              const override;
+        ICompactSet * clone()                                        const override;
+        ReturnCode contains(IVector const * vec, bool & result)      const override;
+        ReturnCode contains(ICompact const * box, bool & result)     const override;
+        ReturnCode containsBatch(double const * points, size_t count, uint8_t * mask) const override;
+        ReturnCode classify(double const * points, size_t count, std::vector<size_t> & offsets, std::vector<size_t> & ids) const override;
+        ReturnCode intersects(ICompact const * box, bool & result)   const override;
+        ReturnCode query(ICompact const * box, std::vector<size_t> & indices) const override;
+        ReturnCode isSubset(ICompactSet const * other, bool & result)   const override;
+        ReturnCode intersects(ICompactSet const * other, bool & result) const override;
+
+        ICompactSetImpl(size_t dim, double tolerance);
+        ~ICompactSetImpl();
+
+        double getTolerance() const;
+        BoxTree const & getTree() const;
+        // boxes one after another as their least and greatest corners, the tree is packed over them at once
+        void build(std::vector<double> const & boxes);
+        // corners of a box of the set dimension, any box is a valid query
+        ReturnCode readBox(ICompact const * box, std::vector<double> & corners) const;
+        // corners of a box to store, it must be at least tolerance wide along every axis
+        ReturnCode readStoredBox(ICompact const * box, std::vector<double> & corners) const;
+    };
+}
+
+ICompactSetImpl::ICompactSetImpl(size_t dim, double tolerance) : _tree(dim), _tolerance(tolerance) {
+    _logger = ILogger::createLogger(this);
+}
+
+ICompactSetImpl::~ICompactSetImpl() {
+    if (_logger != nullptr) {
+        _logger->releaseLogger(this);
+    }
+}
+
+double ICompactSetImpl::getTolerance() const {
+    return _tolerance;
+}
+
+BoxTree const & ICompactSetImpl::getTree() const {
+    return _tree;
+}
+
+void ICompactSetImpl::build(std::vector<double> const & boxes) {
+    _tree.build(boxes);
+}
+
+ReturnCode ICompactSetImpl::readBox(ICompact const * box, std::vector<double> & corners) const {
+    if (box == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    size_t dim = _tree.getDim();
+    if (box->getDim() != dim) {
+        LOG(_logger, ReturnCode::RC_WRONG_DIM);
+        return ReturnCode::RC_WRONG_DIM;
+    }
+    IVector * begin = box->getBegin();
+    IVector * end = box->getEnd();
+    if (begin == nullptr || end == nullptr) {
+        delete begin;
+        delete end;
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    corners.resize(2 * dim);
+    for (size_t i = 0; i < dim; i++) {
+        corners[i] = begin->getCoord(i);
+        corners[dim + i] = end->getCoord(i);
+    }
+    delete begin;
+    delete end;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactSetImpl::readStoredBox(ICompact const * box, std::vector<double> & corners) const {
+    ReturnCode r_code = readBox(box, corners);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    size_t dim = _tree.getDim();
+    for (size_t i = 0; i < dim; i++) {
+        if (corners[dim + i] - corners[i] < _tolerance) {
+            LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+            return ReturnCode::RC_INVALID_PARAMS;
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactSetImpl::insert(ICompact const * box) {
+    std::vector<double> corners;
+    ReturnCode r_code = readStoredBox(box, corners);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    _tree.insert(corners.data(), corners.data() + _tree.getDim());
+    return ReturnCode::RC_SUCCESS;
+}
+
+size_t ICompactSetImpl::getDim() const {
+    return _tree.getDim();
+}
+
+size_t ICompactSetImpl::getSize() const {
+    return _tree.size();
+}
+
+ICompact * ICompactSetImpl::getBox(size_t index) const {
+    if (index >= _tree.size()) {
+        LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
+        return nullptr;
+    }
+    size_t dim = _tree.getDim();
+    IVector * begin = IVector::createVector(dim, const_cast<double *>(_tree.low(index)), _logger);
+    IVector * end = IVector::createVector(dim, const_cast<double *>(_tree.high(index)), _logger);
+    ICompact * box = begin != nullptr && end != nullptr ? ICompact::createCompact(begin, end, _tolerance, _logger) : nullptr;
+    delete begin;
+    delete end;
+    return box;
+}
+
+ICompactSet * ICompactSetImpl::clone() const {
+    ICompactSetImpl * copy = new(std::nothrow) ICompactSetImpl(_tree.getDim(), _tolerance);
+    if (copy == nullptr) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return nullptr;
+    }
+    copy->_tree = _tree;
+    return copy;
+}
+
+ReturnCode ICompactSetImpl::contains(IVector const * vec, bool & result) const {
+    if (vec == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    size_t dim = _tree.getDim();
+    if (vec->getDim() != dim) {
+        LOG(_logger, ReturnCode::RC_WRONG_DIM);
+        return ReturnCode::RC_WRONG_DIM;
+    }
+    std::vector<double> point(dim);
+    for (size_t i = 0; i < dim; i++) {
+        point[i] = vec->getCoord(i);
+    }
+    result = _tree.search(point.data(), point.data(), [](size_t) {
+        return true;
+    });
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactSetImpl::containsBatch(double const * points, size_t count, uint8_t * mask) const {
+    if (points == nullptr || mask == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    size_t dim = _tree.getDim();
+    for (size_t k = 0; k < count; k++) {
+        double const * point = points + k * dim;
+        mask[k] = _tree.search(point, point, [](size_t) {
+            return true;
+        }) ? 1 : 0;
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactSetImpl::classify(double const * points, size_t count, std::vector<size_t> & offsets, std::vector<size_t> & ids) const {
+    if (points == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    _tree.classify(points, count, offsets, ids);
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactSetImpl::contains(ICompact const * box, bool & result) const {
+    std::vector<double> corners;
+    ReturnCode r_code = readBox(box, corners);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    result = _tree.covers(corners.data(), corners.data() + _tree.getDim(), _tolerance);
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactSetImpl::intersects(ICompact const * box, bool & result) const {
+    std::vector<double> corners;
+    ReturnCode r_code = readBox(box, corners);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    result = _tree.search(corners.data(), corners.data() + _tree.getDim(), [](size_t) {
+        return true;
+    });
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactSetImpl::query(ICompact const * box, std::vector<size_t> & indices) const {
+    std::vector<double> corners;
+    ReturnCode r_code = readBox(box, corners);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    indices.clear();
+    _tree.search(corners.data(), corners.data() + _tree.getDim(), [&indices](size_t id) {
+        indices.push_back(id);
+        return false;
+    });
+    std::sort(indices.begin(), indices.end());
+    return ReturnCode::RC_SUCCESS;
+}
+
+static ReturnCode checkSet(ICompactSet const * other, size_t dim, ILogger * logger) {
+    if (other == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    if (other->getDim() != dim) {
+        LOG(logger, ReturnCode::RC_WRONG_DIM);
+        return ReturnCode::RC_WRONG_DIM;
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+// sets are made by createCompactSet only, so the other one is an ICompactSetImpl too
+ReturnCode ICompactSetImpl::isSubset(ICompactSet const * other, bool & result) const {
+    ReturnCode r_code = checkSet(other, _tree.getDim(), _logger);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    BoxTree const & tree = static_cast<ICompactSetImpl const *>(other)->getTree();
+    result = true;
+    for (size_t id = 0; id < _tree.size() && result; id++) {
+        result = tree.covers(_tree.low(id), _tree.high(id), _tolerance);
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ICompactSetImpl::intersects(ICompactSet const * other, bool & result) const {
+    ReturnCode r_code = checkSet(other, _tree.getDim(), _logger);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    BoxTree const & tree = static_cast<ICompactSetImpl const *>(other)->getTree();
+    result = false;
+    for (size_t id = 0; id < _tree.size() && !result; id++) {
+        result = tree.search(_tree.low(id), _tree.high(id), [](size_t) {
+            return true;
+        });
+    }
+    return ReturnCode::RC_SUCCESS;
+}
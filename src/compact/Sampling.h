@@ -0,0 +1,231 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <cstdint>
+#include <vector>
+
+namespace {
+    // splitmix64 finalizer, every random value of a sample is a hash of the seed, the axis and the sample number,
+    // so any range of samples is generated independently of the others
+    inline uint64_t mixBits(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    inline uint64_t mixBits(uint64_t seed, uint64_t axis, uint64_t index) {
+        return mixBits(mixBits(mixBits(seed) ^ axis) ^ index);
+    }
+
+    // uniform in [0, 1)
+    inline double unitDouble(uint64_t bits) {
+        return (double)(bits >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    // Sobol sequence of 32-bit fractions; primitive polynomials are taken in the order of their degree and
+    // coefficients, initial direction numbers of the first axes are those of S. Joe and F. Y. Kuo (new-joe-kuo-6.21201),
+    // further axes get random odd ones, which keeps the sequence a digital net but with weaker projections
+    class SobolSequence {
+    public:
+        static size_t const BITS = 32;
+        static size_t const MAX_AXES = 1024;
+
+        explicit SobolSequence(size_t dim) : _dim(dim), _directions(dim * BITS) {
+            for (size_t i = 0; i < BITS; i++) {
+                _directions[i] = 1U << (BITS - 1 - i);
+            }
+            uint32_t poly = 1;
+            for (size_t j = 1; j < _dim; j++) {
+                poly = nextPrimitive(poly);
+                initAxis(j, poly);
+            }
+        }
+
+        // fractions of the sample with the given number, the number must be less than 2^32
+        void point(uint64_t index, uint32_t * x) const {
+            uint64_t gray = index ^ (index >> 1);
+            for (size_t j = 0; j < _dim; j++) {
+                uint32_t value = 0;
+                for (size_t i = 0; i < BITS; i++) {
+                    if ((gray >> i) & 1) {
+                        value ^= _directions[j * BITS + i];
+                    }
+                }
+                x[j] = value;
+            }
+        }
+
+        // fractions of the sample index + 1 from those of index in Gray code order
+        void next(uint64_t index, uint32_t * x) const {
+            size_t bit = 0;
+            while ((index >> bit) & 1) {
+                bit++;
+            }
+            for (size_t j = 0; j < _dim; j++) {
+                x[j] ^= _directions[j * BITS + bit];
+            }
+        }
+
+    private:
+        static size_t const TABLE_AXES = 21;
+
+        static size_t degree(uint32_t poly) {
+            size_t res = 0;
+            while (poly >> (res + 1)) {
+                res++;
+            }
+            return res;
+        }
+
+        // product of polynomials over GF(2) modulo poly of degree s, operands of degree below s
+        static uint32_t mulMod(uint32_t a, uint32_t b, uint32_t poly, size_t s) {
+            uint32_t res = 0;
+            for (; b != 0; b >>= 1) {
+                if (b & 1) {
+                    res ^= a;
+                }
+                a <<= 1;
+                if ((a >> s) & 1) {
+                    a ^= poly;
+                }
+            }
+            return res;
+        }
+
+        static uint32_t powX(uint64_t e, uint32_t poly, size_t s) {
+            uint32_t res = 1, base = s == 1 ? (2 ^ poly) : 2;
+            for (; e != 0; e >>= 1) {
+                if (e & 1) {
+                    res = mulMod(res, base, poly, s);
+                }
+                base = mulMod(base, base, poly, s);
+            }
+            return res;
+        }
+
+        // x has the order 2^s - 1 modulo a primitive polynomial
+        static bool primitive(uint32_t poly) {
+            size_t s = degree(poly);
+            uint64_t order = (1ULL << s) - 1;
+            if (powX(order, poly, s) != 1) {
+                return false;
+            }
+            uint64_t rest = order;
+            for (uint64_t p = 2; p * p <= rest; p++) {
+                if (rest % p == 0) {
+                    if (powX(order / p, poly, s) == 1) {
+                        return false;
+                    }
+                    while (rest % p == 0) {
+                        rest /= p;
+                    }
+                }
+            }
+            return rest == 1 || rest == order || powX(order / rest, poly, s) != 1;
+        }
+
+        // polynomials x^s + ... + 1 after poly, by degree and then by the bits of the middle coefficients
+        static uint32_t nextPrimitive(uint32_t poly) {
+            do {
+                size_t s = degree(poly);
+                poly += 2;
+                if (degree(poly) > s) {
+                    poly = (1U << (s + 1)) | 1;
+                }
+            } while (!primitive(poly));
+            return poly;
+        }
+
+        void initAxis(size_t j, uint32_t poly) {
+            static uint32_t const table[TABLE_AXES - 1][7] = {
+                {1}, {1, 3}, {1, 3, 1}, {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13}, {1, 1, 5, 5, 17}, {1, 1, 5, 5, 5},
+                {1, 1, 7, 11, 19}, {1, 1, 5, 1, 1}, {1, 1, 1, 3, 11}, {1, 3, 5, 5, 31}, {1, 3, 3, 9, 7, 49},
+                {1, 1, 1, 15, 21, 21}, {1, 3, 1, 13, 27, 49}, {1, 1, 1, 15, 7, 5}, {1, 3, 1, 15, 13, 25},
+                {1, 1, 5, 5, 19, 61}, {1, 3, 7, 11, 23, 15, 103}, {1, 3, 7, 13, 13, 15, 69}
+            };
+            size_t s = degree(poly);
+            uint32_t * v = _directions.data() + j * BITS;
+            for (size_t i = 0; i < s && i < BITS; i++) {
+                uint32_t m = j < TABLE_AXES ? table[j - 1][i] : (uint32_t)(mixBits(s, j, i) % (2U << i)) | 1;
+                v[i] = m << (BITS - 1 - i);
+            }
+            for (size_t i = s; i < BITS; i++) {
+                v[i] = v[i - s] ^ (v[i - s] >> s);
+                for (size_t k = 1; k < s; k++) {
+                    if ((poly >> (s - k)) & 1) {
+                        v[i] ^= v[i - k];
+                    }
+                }
+            }
+        }
+
+        size_t _dim;
+        std::vector<uint32_t> _directions;
+    };
+
+    inline std::vector<uint64_t> firstPrimes(size_t count) {
+        std::vector<uint64_t> primes;
+        for (uint64_t n = 2; primes.size() < count; n++) {
+            bool prime = true;
+            for (size_t k = 0; k < primes.size() && primes[k] * primes[k] <= n; k++) {
+                if (n % primes[k] == 0) {
+                    prime = false;
+                    break;
+                }
+            }
+            if (prime) {
+                primes.push_back(n);
+            }
+        }
+        return primes;
+    }
+
+    // digits of index in the given base mirrored around the point
+    inline double radicalInverse(uint64_t index, uint64_t base) {
+        double res = 0, scale = 1.0 / base;
+        for (; index != 0; index /= base, scale /= base) {
+            res += (double)(index % base) * scale;
+        }
+        return res;
+    }
+
+    // pseudo-random permutation of [0, n) computed element by element: a Feistel network over the smallest
+    // even number of bits covering n, values out of range are encrypted again until they fall in it
+    class IndexPermutation {
+    public:
+        IndexPermutation(uint64_t n, uint64_t key) : _n(n), _key(key) {
+            while (_half < 32 && (1ULL << (2 * _half)) < n) {
+                _half++;
+            }
+            _mask = (1ULL << _half) - 1;
+        }
+
+        uint64_t operator()(uint64_t index) const {
+            do {
+                index = encrypt(index);
+            } while (index >= _n);
+            return index;
+        }
+
+    private:
+        static size_t const ROUNDS = 4;
+
+        uint64_t encrypt(uint64_t value) const {
+            uint64_t left = value >> _half, right = value & _mask;
+            for (size_t r = 0; r < ROUNDS; r++) {
+                uint64_t next = left ^ (mixBits(_key, r, right) & _mask);
+                left = right;
+                right = next;
+            }
+            return (left << _half) | right;
+        }
+
+        uint64_t _n;
+        uint64_t _key;
+        size_t _half {0};
+        uint64_t _mask {0};
+    };
+}
+
+#endif /* SAMPLING_H */
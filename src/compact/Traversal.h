@@ -0,0 +1,172 @@
+#ifndef TRAVERSAL_H
+#define TRAVERSAL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    inline size_t saturatingMul(size_t a, size_t b) {
+        return a != 0 && b > SIZE_MAX / a ? SIZE_MAX : a * b;
+    }
+
+    // Hilbert curve over the smallest cube of side 2^bits containing the lattice, points outside it are skipped;
+    // positions of lattice points along the curve are found by descending the curve through aligned subcubes
+    // and counting the lattice points in them
+    class LatticeHilbert {
+    public:
+        static size_t const KEY_BITS = 64;
+        // every level of the descent checks 2^axes subcubes
+        static size_t const MAX_AXES = 10;
+
+        explicit LatticeHilbert(std::vector<size_t> const & counts) : _counts(counts), _dim(counts.size()), _bits(1) {
+            size_t max_count = *std::max_element(_counts.begin(), _counts.end());
+            while (_bits < KEY_BITS && (max_count - 1) >> _bits != 0) {
+                _bits++;
+            }
+        }
+
+        bool supported() const {
+            return _dim <= MAX_AXES && _dim * _bits <= KEY_BITS;
+        }
+
+        bool inside(uint64_t const * coords) const {
+            for (size_t i = 0; i < _dim; i++) {
+                if (coords[i] >= _counts[i]) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        uint64_t encode(uint64_t const * coords) const {
+            uint64_t x[MAX_AXES];
+            std::copy(coords, coords + _dim, x);
+            if (_dim > 1) {
+                toTranspose(x);
+            }
+            uint64_t key = 0;
+            for (size_t level = _bits; level-- > 0;) {
+                for (size_t i = 0; i < _dim; i++) {
+                    key = (key << 1) | ((x[i] >> level) & 1);
+                }
+            }
+            return key;
+        }
+
+        void decode(uint64_t key, uint64_t * coords) const {
+            std::fill(coords, coords + _dim, 0);
+            for (size_t level = _bits; level-- > 0;) {
+                for (size_t i = 0; i < _dim; i++) {
+                    coords[i] |= ((key >> (_dim * level + _dim - 1 - i)) & 1) << level;
+                }
+            }
+            if (_dim > 1) {
+                fromTranspose(coords);
+            }
+        }
+
+        // key of the lattice point with the given number along the curve
+        uint64_t select(size_t position) const {
+            uint64_t high = 0;
+            for (size_t level = _bits; level-- > 0;) {
+                for (uint64_t digit = 0; ; digit++) {
+                    uint64_t prefix = (high << _dim) | digit;
+                    size_t count = boxCount(prefix << (_dim * level), level);
+                    if (position < count) {
+                        high = prefix;
+                        break;
+                    }
+                    position -= count;
+                }
+            }
+            return high;
+        }
+
+        // number of lattice points before the one with the given key
+        size_t rank(uint64_t key) const {
+            uint64_t mask = (1ULL << _dim) - 1;
+            uint64_t high = 0;
+            size_t res = 0;
+            for (size_t level = _bits; level-- > 0;) {
+                uint64_t digit = (key >> (_dim * level)) & mask;
+                for (uint64_t cur = 0; cur < digit; cur++) {
+                    res += boxCount(((high << _dim) | cur) << (_dim * level), level);
+                }
+                high = (high << _dim) | digit;
+            }
+            return res;
+        }
+
+    private:
+        // lattice points in the subcube of side 2^level the curve fills around the point with the given key
+        size_t boxCount(uint64_t key, size_t level) const {
+            uint64_t coords[MAX_AXES];
+            decode(key, coords);
+            size_t res = 1;
+            for (size_t i = 0; i < _dim; i++) {
+                uint64_t corner = coords[i] >> level << level;
+                if (corner >= _counts[i]) {
+                    return 0;
+                }
+                res = saturatingMul(res, (size_t)std::min<uint64_t>(1ULL << level, _counts[i] - corner));
+            }
+            return res;
+        }
+
+        // J. Skilling, "Programming the Hilbert curve": axes to the transposed Hilbert index and back
+        void toTranspose(uint64_t * x) const {
+            uint64_t m = 1ULL << (_bits - 1);
+            for (uint64_t q = m; q > 1; q >>= 1) {
+                uint64_t p = q - 1;
+                for (size_t i = 0; i < _dim; i++) {
+                    if (x[i] & q) {
+                        x[0] ^= p;
+                    } else {
+                        uint64_t t = (x[0] ^ x[i]) & p;
+                        x[0] ^= t;
+                        x[i] ^= t;
+                    }
+                }
+            }
+            for (size_t i = 1; i < _dim; i++) {
+                x[i] ^= x[i - 1];
+            }
+            uint64_t t = 0;
+            for (uint64_t q = m; q > 1; q >>= 1) {
+                if (x[_dim - 1] & q) {
+                    t ^= q - 1;
+                }
+            }
+            for (size_t i = 0; i < _dim; i++) {
+                x[i] ^= t;
+            }
+        }
+
+        void fromTranspose(uint64_t * x) const {
+            uint64_t t = x[_dim - 1] >> 1;
+            for (size_t i = _dim - 1; i > 0; i--) {
+                x[i] ^= x[i - 1];
+            }
+            x[0] ^= t;
+            for (uint64_t q = 2; q != (1ULL << (_bits - 1)) << 1 && q != 0; q <<= 1) {
+                uint64_t p = q - 1;
+                for (size_t i = _dim; i-- > 0;) {
+                    if (x[i] & q) {
+                        x[0] ^= p;
+                    } else {
+                        t = (x[0] ^ x[i]) & p;
+                        x[0] ^= t;
+                        x[i] ^= t;
+                    }
+                }
+            }
+        }
+
+        std::vector<size_t> _counts;
+        size_t _dim;
+        size_t _bits;
+    };
+}
+
+#endif /* TRAVERSAL_H */
@@ -0,0 +1,601 @@
+#ifndef ICOMPACT_ALGORITHMS_H
+#define ICOMPACT_ALGORITHMS_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ICompact.h"
+
+// points are numbered as by an iterator from begin, axis 0 changing fastest; a point is a view computing
+// its coordinates from its number, so iterators are plain numbers and may be used by several threads at once;
+// iterators and points stay valid while some copy of the lattice exists
+class ICompact::Lattice {
+private:
+    struct Shape {
+        size_t dim;
+        size_t size;
+        std::vector<double> origin;
+        std::vector<double> steps;
+        std::vector<size_t> counts;
+        std::vector<size_t> strides;
+    };
+
+public:
+    class Point {
+    public:
+        Point() = default;
+
+        size_t size() const {
+            return _shape == nullptr ? 0 : _shape->dim;
+        }
+        size_t position() const {
+            return _position;
+        }
+        double operator[](size_t axis) const {
+            return _shape->origin[axis] + (double)(_position / _shape->strides[axis] % _shape->counts[axis]) * _shape->steps[axis];
+        }
+        // size() coordinates without a division per axis
+        void copyTo(double* point) const {
+            size_t rest = _position;
+            for (size_t i = 0; i < _shape->dim; i++) {
+                point[i] = _shape->origin[i] + (double)(rest % _shape->counts[i]) * _shape->steps[i];
+                rest /= _shape->counts[i];
+            }
+        }
+
+    private:
+        friend class Lattice;
+        Point(Shape const* shape, size_t position) : _shape(shape), _position(position) {
+        }
+
+        Shape const* _shape {nullptr};
+        size_t _position {0};
+    };
+
+    // dereferencing gives a point by value, as a proxy reference
+    class iterator {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef Point value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef Point const* pointer;
+        typedef Point reference;
+
+        iterator() = default;
+
+        Point operator*() const {
+            return Point(_shape, _position);
+        }
+        Point operator[](difference_type n) const {
+            return Point(_shape, _position + n);
+        }
+        iterator& operator++() {
+            _position++;
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator res(*this);
+            _position++;
+            return res;
+        }
+        iterator& operator--() {
+            _position--;
+            return *this;
+        }
+        iterator operator--(int) {
+            iterator res(*this);
+            _position--;
+            return res;
+        }
+        iterator& operator+=(difference_type n) {
+            _position += n;
+            return *this;
+        }
+        iterator& operator-=(difference_type n) {
+            _position -= n;
+            return *this;
+        }
+        iterator operator+(difference_type n) const {
+            return iterator(_shape, _position + n);
+        }
+        friend iterator operator+(difference_type n, iterator const& it) {
+            return it + n;
+        }
+        iterator operator-(difference_type n) const {
+            return iterator(_shape, _position - n);
+        }
+        difference_type operator-(iterator const& other) const {
+            return (difference_type)_position - (difference_type)other._position;
+        }
+        bool operator==(iterator const& other) const {
+            return _position == other._position;
+        }
+        bool operator!=(iterator const& other) const {
+            return _position != other._position;
+        }
+        bool operator<(iterator const& other) const {
+            return _position < other._position;
+        }
+        bool operator>(iterator const& other) const {
+            return _position > other._position;
+        }
+        bool operator<=(iterator const& other) const {
+            return _position <= other._position;
+        }
+        bool operator>=(iterator const& other) const {
+            return _position >= other._position;
+        }
+
+    private:
+        friend class Lattice;
+        iterator(Shape const* shape, size_t position) : _shape(shape), _position(position) {
+        }
+
+        Shape const* _shape {nullptr};
+        size_t _position {0};
+    };
+    typedef iterator const_iterator;
+
+    Lattice() = default;
+
+    iterator begin() const {
+        return iterator(_shape.get(), 0);
+    }
+    iterator end() const {
+        return iterator(_shape.get(), size());
+    }
+    size_t size() const {
+        return _shape == nullptr ? 0 : _shape->size;
+    }
+    bool empty() const {
+        return size() == 0;
+    }
+    size_t getDim() const {
+        return _shape == nullptr ? 0 : _shape->dim;
+    }
+    Point operator[](size_t position) const {
+        return Point(_shape.get(), position);
+    }
+
+private:
+    friend class ICompact;
+
+    std::shared_ptr<Shape const> _shape;
+};
+
+// the number of points must fit the difference type of iterators
+inline ICompact::Lattice ICompact::lattice(IVector const* step) const {
+    Lattice res;
+    std::vector<size_t> counts;
+    if (getGridShape(step, counts) != ReturnCode::RC_SUCCESS) {
+        return res;
+    }
+    // the shape is only returned when the number of points fits size_t
+    size_t count = 1;
+    for (auto axis_count : counts) {
+        count *= axis_count;
+    }
+    if (count > (size_t)PTRDIFF_MAX) {
+        return res;
+    }
+    IVector* origin = getBegin();
+    if (origin == nullptr) {
+        return res;
+    }
+    std::shared_ptr<Lattice::Shape> shape(new(std::nothrow) Lattice::Shape());
+    if (shape != nullptr) {
+        shape->dim = counts.size();
+        shape->size = count;
+        shape->counts = counts;
+        shape->origin.resize(shape->dim);
+        shape->steps.resize(shape->dim);
+        shape->strides.resize(shape->dim);
+        size_t stride = 1;
+        for (size_t i = 0; i < shape->dim; i++) {
+            shape->origin[i] = origin->getCoord(i);
+            shape->steps[i] = step->getCoord(i);
+            shape->strides[i] = stride;
+            stride *= counts[i];
+        }
+        res._shape = shape;
+    }
+    delete origin;
+    return res;
+}
+
+inline ReturnCode ICompact::planChunks(IVector const* step, size_t& threads, size_t& chunkSize, size_t& count, size_t& chunks) const {
+    ReturnCode r_code = getGridSize(step, count);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    // enough chunks for threads to even out, few enough points in one to keep the buffer of a thread small
+    size_t const max_chunk = 1024;
+    if (chunkSize == 0) {
+        chunkSize = std::max<size_t>(1, std::min(max_chunk, count / (16 * threads)));
+    }
+    // an empty grid has no chunks and needs no threads
+    if (count == 0) {
+        chunks = 0;
+        threads = 0;
+        return ReturnCode::RC_SUCCESS;
+    }
+    chunks = (count - 1) / chunkSize + 1;
+    threads = std::min(threads, chunks);
+    return ReturnCode::RC_SUCCESS;
+}
+
+// every thread walks its own iterator, a chunk is decoded into the thread buffer by one virtual call
+template <class Body>
+ReturnCode ICompact::runChunks(IVector const* step, size_t threads, size_t chunkSize, size_t count, size_t chunks, Body body) {
+    if (chunks == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+    std::vector<Iterator*> iterators(threads, nullptr);
+    for (auto& iterator : iterators) {
+        if ((iterator = begin(step)) == nullptr) {
+            for (auto created : iterators) {
+                delete created;
+            }
+            return ReturnCode::RC_NO_MEM;
+        }
+    }
+    std::atomic<size_t> next_chunk(0);
+    size_t dim = getDim();
+    auto work = [&](Iterator* iterator) {
+        std::vector<double> points(chunkSize * dim);
+        for (size_t chunk = next_chunk++; chunk < chunks; chunk = next_chunk++) {
+            size_t first = chunk * chunkSize;
+            iterator->seek(first);
+            size_t got = iterator->getPoints(points.data(), std::min(chunkSize, count - first));
+            body(chunk, first, static_cast<double const*>(points.data()), got, dim);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; t++) {
+        workers.push_back(std::thread(work, iterators[t]));
+    }
+    work(iterators[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto iterator : iterators) {
+        delete iterator;
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+template <class T, class Fn, class Combine>
+ReturnCode ICompact::parallelReduce(IVector const* step, T const& init, Fn fn, Combine combine, T& result,
+                                    size_t threads, size_t chunkSize) {
+    size_t count, chunks;
+    ReturnCode r_code = planChunks(step, threads, chunkSize, count, chunks);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    if (chunks == 0) {
+        result = init;
+        return ReturnCode::RC_SUCCESS;
+    }
+    std::vector<T> partials(chunks, init);
+    r_code = runChunks(step, threads, chunkSize, count, chunks,
+                       [&](size_t chunk, size_t, double const* points, size_t got, size_t dim) {
+        T& accumulator = partials[chunk];
+        for (size_t p = 0; p < got; p++) {
+            fn(accumulator, points + p * dim);
+        }
+    });
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    result = partials[0];
+    for (size_t chunk = 1; chunk < chunks; chunk++) {
+        combine(result, static_cast<T const&>(partials[chunk]));
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+template <class Fn>
+ReturnCode ICompact::parallelForEach(IVector const* step, Fn fn, size_t threads, size_t chunkSize) {
+    size_t count, chunks;
+    ReturnCode r_code = planChunks(step, threads, chunkSize, count, chunks);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    return runChunks(step, threads, chunkSize, count, chunks,
+                     [&](size_t, size_t first, double const* points, size_t got, size_t dim) {
+        for (size_t p = 0; p < got; p++) {
+            fn(points + p * dim, first + p);
+        }
+    });
+}
+
+// integer coordinates of points count steps of the finest level, 2^maxDepth of them per lattice step
+template <class Fn>
+ReturnCode ICompact::refine(IVector const* step, Fn fn, double threshold, size_t maxDepth, Refinement& result, size_t threads) const {
+    std::vector<size_t> counts;
+    ReturnCode r_code = getGridShape(step, counts);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        return r_code;
+    }
+    size_t dim = counts.size();
+    std::vector<size_t> axes;
+    for (size_t i = 0; i < dim; i++) {
+        if (counts[i] > 1) {
+            axes.push_back(i);
+        }
+    }
+    if (!(threshold >= 0) || axes.size() > Refinement::MAX_AXES || maxDepth >= 32) {
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    uint64_t const top = 1ULL << maxDepth;
+    std::vector<uint64_t> strides(dim, 0);
+    uint64_t key_space = 1;
+    for (auto i : axes) {
+        uint64_t extent = (uint64_t)(counts[i] - 1) * top + 1;
+        if ((counts[i] - 1) > UINT64_MAX / top || key_space > UINT64_MAX / extent) {
+            return ReturnCode::RC_OUT_OF_BOUNDS;
+        }
+        strides[i] = key_space;
+        key_space *= extent;
+    }
+    IVector* begin_point = getBegin();
+    if (begin_point == nullptr) {
+        return ReturnCode::RC_NO_MEM;
+    }
+    std::vector<double> origin(dim), steps(dim);
+    for (size_t i = 0; i < dim; i++) {
+        origin[i] = begin_point->getCoord(i);
+        steps[i] = step->getCoord(i) / (double)top;
+    }
+    delete begin_point;
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    result = Refinement();
+    result.dim = dim;
+    // coarse cells in the lexicographic order of their least corners
+    std::vector<uint64_t> cells(dim, 0), lows, coords(dim, 0);
+    std::vector<size_t> frontier;
+    for (bool more = true; more; ) {
+        frontier.push_back(result.depths.size());
+        result.depths.push_back(0);
+        result.parents.push_back(SIZE_MAX);
+        result.children.push_back(SIZE_MAX);
+        lows.insert(lows.end(), cells.begin(), cells.end());
+        more = false;
+        for (auto i : axes) {
+            if ((cells[i] += top) < (counts[i] - 1) * top) {
+                more = true;
+                break;
+            }
+            cells[i] = 0;
+        }
+    }
+
+    size_t const corners = (size_t)1 << axes.size();
+    std::unordered_map<uint64_t, size_t> evaluated;
+    // corner m of a cell is shifted by side along the axes of the set bits of m, m == corners is the center
+    auto point = [&](uint64_t const* low, uint64_t side, size_t m) {
+        uint64_t key = 0;
+        for (size_t a = 0; a < axes.size(); a++) {
+            size_t i = axes[a];
+            coords[i] = low[i] + (m == corners ? side / 2 : ((m >> a) & 1) * side);
+            key += coords[i] * strides[i];
+        }
+        return key;
+    };
+    for (size_t depth = 0; !frontier.empty(); depth++) {
+        uint64_t side = top >> depth;
+        size_t first_new = result.values.size();
+        for (auto cell : frontier) {
+            for (size_t m = 0; m <= corners; m++) {
+                if (m == corners && depth == maxDepth) {
+                    break;
+                }
+                uint64_t key = point(lows.data() + cell * dim, side, m);
+                if (evaluated.insert(std::make_pair(key, result.values.size())).second) {
+                    for (size_t i = 0; i < dim; i++) {
+                        result.points.push_back(origin[i] + (double)coords[i] * steps[i]);
+                    }
+                    result.values.push_back(0);
+                }
+            }
+        }
+
+        size_t fresh = result.values.size() - first_new;
+        size_t workers = std::min(threads, fresh);
+        auto evaluate = [&](size_t from, size_t to) {
+            for (size_t p = from; p < to; p++) {
+                result.values[p] = fn(static_cast<double const*>(result.points.data() + p * dim));
+            }
+        };
+        if (workers <= 1) {
+            evaluate(first_new, first_new + fresh);
+        } else {
+            std::vector<std::thread> pool;
+            for (size_t t = 0; t < workers; t++) {
+                pool.push_back(std::thread(evaluate, first_new + t * fresh / workers, first_new + (t + 1) * fresh / workers));
+            }
+            for (auto& worker : pool) {
+                worker.join();
+            }
+        }
+        if (depth == maxDepth) {
+            break;
+        }
+
+        std::vector<size_t> next;
+        for (auto cell : frontier) {
+            double min = result.values[evaluated[point(lows.data() + cell * dim, side, 0)]], max = min;
+            for (size_t m = 1; m <= corners; m++) {
+                double value = result.values[evaluated[point(lows.data() + cell * dim, side, m)]];
+                min = std::min(min, value);
+                max = std::max(max, value);
+            }
+            if (!(max - min > threshold)) {
+                continue;
+            }
+            result.children[cell] = result.depths.size();
+            for (size_t m = 0; m < corners; m++) {
+                point(lows.data() + cell * dim, side / 2, m);
+                next.push_back(result.depths.size());
+                result.depths.push_back(depth + 1);
+                result.parents.push_back(cell);
+                result.children.push_back(SIZE_MAX);
+                lows.insert(lows.end(), coords.begin(), coords.end());
+            }
+        }
+        frontier.swap(next);
+    }
+
+    result.lows.resize(lows.size());
+    result.highs.resize(lows.size());
+    for (size_t cell = 0; cell < result.depths.size(); cell++) {
+        uint64_t side = top >> result.depths[cell];
+        for (size_t i = 0; i < dim; i++) {
+            uint64_t low = lows[cell * dim + i];
+            result.lows[cell * dim + i] = origin[i] + (double)low * steps[i];
+            result.highs[cell * dim + i] = origin[i] + (double)(counts[i] > 1 ? low + side : low) * steps[i];
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+// a box keeps its corners and the bound of its parent, so bounds never decrease down the tree;
+// equal bounds are taken in the order the boxes were made, which makes a single thread deterministic
+template <class Fn, class Bound>
+ReturnCode ICompact::minimize(Fn fn, Bound bound, double tolerance, double width, Optimum& result,
+                              size_t threads, size_t maxBoxes) const {
+    if (!(tolerance >= 0) || !(width > 0)) {
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    IVector* begin_point = getBegin();
+    IVector* end_point = getEnd();
+    if (begin_point == nullptr || end_point == nullptr) {
+        delete begin_point;
+        delete end_point;
+        return ReturnCode::RC_NO_MEM;
+    }
+    size_t dim = begin_point->getDim();
+    struct Box {
+        double bound;
+        size_t order;
+        std::vector<double> corners;
+
+        bool operator<(Box const& other) const {
+            return bound > other.bound || (bound == other.bound && order > other.order);
+        }
+    };
+    Box root {0, 0, std::vector<double>(2 * dim)};
+    for (size_t i = 0; i < dim; i++) {
+        root.corners[i] = begin_point->getCoord(i);
+        root.corners[dim + i] = end_point->getCoord(i);
+    }
+    delete begin_point;
+    delete end_point;
+    root.bound = bound(static_cast<double const*>(root.corners.data()), static_cast<double const*>(root.corners.data() + dim));
+
+    result = Optimum();
+    result.value = std::numeric_limits<double>::infinity();
+    std::priority_queue<Box> queue;
+    queue.push(root);
+    size_t made = 1, active = 0;
+    bool stopped = false;
+    std::mutex lock;
+    std::condition_variable changed;
+
+    auto work = [&]() {
+        std::vector<double> center(dim);
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            changed.wait(guard, [&]() {
+                return !queue.empty() || active == 0 || stopped;
+            });
+            if (queue.empty() || stopped) {
+                return;
+            }
+            // the queue is ordered by bound, so the rest cannot beat the best value either
+            if (!(queue.top().bound < result.value - tolerance)) {
+                queue = std::priority_queue<Box>();
+                changed.notify_all();
+                continue;
+            }
+            if (result.evaluations == maxBoxes) {
+                stopped = true;
+                changed.notify_all();
+                return;
+            }
+            Box box = queue.top();
+            queue.pop();
+            result.evaluations++;
+            active++;
+            guard.unlock();
+
+            double const* low = box.corners.data();
+            double const* high = low + dim;
+            size_t axis = 0;
+            for (size_t i = 0; i < dim; i++) {
+                center[i] = low[i] + (high[i] - low[i]) / 2;
+                if (high[i] - low[i] > high[axis] - low[axis]) {
+                    axis = i;
+                }
+            }
+            double value = fn(static_cast<double const*>(center.data()));
+            std::vector<Box> children;
+            if (high[axis] - low[axis] >= width) {
+                for (size_t half = 0; half < 2; half++) {
+                    Box child {box.bound, 0, box.corners};
+                    child.corners[half == 0 ? dim + axis : axis] = center[axis];
+                    double child_bound = bound(static_cast<double const*>(child.corners.data()),
+                                               static_cast<double const*>(child.corners.data() + dim));
+                    child.bound = std::max(box.bound, child_bound);
+                    children.push_back(child);
+                }
+            }
+
+            guard.lock();
+            if (value < result.value) {
+                result.value = value;
+                result.point = center;
+            }
+            for (auto& child : children) {
+                if (child.bound < result.value - tolerance) {
+                    child.order = made++;
+                    queue.push(child);
+                }
+            }
+            active--;
+            changed.notify_all();
+        }
+    };
+
+    if (threads == 0) {
+        threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++) {
+        pool.push_back(std::thread(work));
+    }
+    work();
+    for (auto& worker : pool) {
+        worker.join();
+    }
+    result.proven = !stopped;
+    return ReturnCode::RC_SUCCESS;
+}
+
+#endif /* ICOMPACT_ALGORITHMS_H */
\ No newline at end of file
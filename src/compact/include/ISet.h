@@ -6,25 +6,139 @@
 #include "ReturnCode.h"
 #include "Export.h"
 #include <cstddef> // size_t
+#include <cstdio>  // FILE
+#include <vector>
+
+class ICompact;
 
 class DECLSPEC ISet {
 public:
+    // writes up to maxCount points into buffer one after another, returns number of written points (0 at the end)
+    typedef size_t (*PullPoints)(void* context, double* buffer, size_t maxCount);
+    // receives a block of count points
+    typedef ReturnCode (*PushPoints)(void* context, double const* points, size_t count);
+    // receives a block of count pairs of indices stored as i0, j0, i1, j1, ...
+    typedef ReturnCode (*PushPairs)(void* context, size_t const* pairs, size_t count);
+
+    // order of elements in storage: as inserted or by the key of their grid cell on a space-filling curve
+    enum class StorageOrder {
+        INSERTION,
+        MORTON,
+        HILBERT
+    };
+    // coordinates kept as doubles, floats or 32-bit multiples of a step counted from the bounding box minimum
+    enum class StorageFormat {
+        FLOAT64,
+        FLOAT32,
+        QUANTIZED
+    };
+    // what stands for a cluster in the result of clusterSummary
+    enum class ClusterSummary {
+        CENTROIDS,
+        REPRESENTATIVES
+    };
+
     static ISet* createSet(ILogger* logger = nullptr);
+    // set saved by save(), coordinates are read from the mapped file until the set is modified
+    static ISet* openMapped(char const* path, ILogger* logger = nullptr);
     static ISet* _union(ISet const* set1, ISet const* set2, IVector::Norm norm, double tolerance, ILogger* logger = nullptr);
     static ISet* difference(ISet const* minuend, ISet const* subtrahend, IVector::Norm norm, double tolerance, ILogger* logger = nullptr);
     static ISet* symmetricDifference(ISet const* set1, ISet const* set2, IVector::Norm norm, double tolerance, ILogger* logger = nullptr);
     static ISet* intersection(ISet const* set1, ISet const* set2, IVector::Norm norm, double tolerance, ILogger* logger = nullptr);
 
+    // clusters are connected components of the graph linking elements closer than tolerance, so unlike insert
+    // they do not depend on insertion order; labels[i] is the cluster of element i, clusters are numbered
+    // in order of their first elements; threads == 0 uses all hardware threads
+    static ReturnCode cluster(ISet const* set, IVector::Norm norm, double tolerance, std::vector<size_t>& labels,
+                              size_t& clusterCount, size_t threads = 1, ILogger* logger = nullptr);
+    // one point per cluster, its centroid or the element closest to the centroid, in order of the clusters one after
+    // another; summaries of two clusters may be within tolerance or even equal, so they are points and not a set
+    static ReturnCode clusterSummary(ISet const* set, IVector::Norm norm, double tolerance, ClusterSummary summary,
+                                     std::vector<double>& points, size_t threads = 1, ILogger* logger = nullptr);
+
+    // one pass over the elements split between threads (0 means all hardware threads): per-axis minimum, maximum
+    // and mean, and the dim x dim covariance matrix row after row, divided by the number of elements minus one
+    static ReturnCode statistics(ISet const* set, std::vector<double>& min, std::vector<double>& max, std::vector<double>& mean,
+                                 std::vector<double>& covariance, size_t threads = 1, ILogger* logger = nullptr);
+    // counts[axis * bins + bin] of elements in equal bins between the minimum and the maximum along the axis
+    static ReturnCode axisHistograms(ISet const* set, size_t bins, std::vector<size_t>& counts, size_t threads = 1, ILogger* logger = nullptr);
+    // counts of elements with norm in equal bins between 0 and maxNorm, the largest norm of an element
+    static ReturnCode normHistogram(ISet const* set, IVector::Norm norm, size_t bins, std::vector<size_t>& counts, double& maxNorm,
+                                    size_t threads = 1, ILogger* logger = nullptr);
+
+    // every pair (i, j), i < j, of elements closer than tolerance, pushed in blocks; pairCount is the number of pairs
+    static ReturnCode selfJoin(ISet const* set, IVector::Norm norm, double tolerance, PushPairs push, void* pushContext,
+                               size_t& pairCount, ILogger* logger = nullptr);
+    // the same collected into pairs as i0, j0, i1, j1, ...
+    static ReturnCode selfJoin(ISet const* set, IVector::Norm norm, double tolerance, std::vector<size_t>& pairs, ILogger* logger = nullptr);
+    // the same for count points of dimension dim stored one after another
+    static ReturnCode selfJoin(double const* points, size_t count, size_t dim, IVector::Norm norm, double tolerance,
+                               PushPairs push, void* pushContext, size_t& pairCount, ILogger* logger = nullptr);
+    // every pair (i, j) of an element i of set1 and an element j of set2 closer than tolerance
+    static ReturnCode join(ISet const* set1, ISet const* set2, IVector::Norm norm, double tolerance, PushPairs push, void* pushContext,
+                           size_t& pairCount, ILogger* logger = nullptr);
+
+    // deduplication of a stream which may not fit into memory: no two pushed points are within tolerance
+    // and every input point is within tolerance of a pushed one; points are pushed in order of one of the axes,
+    // runs over memoryBudget bytes are spilled to temporary files
+    static ReturnCode dedupStream(size_t dim, PullPoints pull, void* pullContext, PushPoints push, void* pushContext,
+                                  IVector::Norm norm, double tolerance, size_t memoryBudget, size_t& resultSize, ILogger* logger = nullptr);
+    // the same for raw doubles read from a binary file
+    static ReturnCode dedupStream(size_t dim, FILE* input, PushPoints push, void* pushContext,
+                                  IVector::Norm norm, double tolerance, size_t memoryBudget, size_t& resultSize, ILogger* logger = nullptr);
+
+    // zero tolerance means exact equality of coordinates (-0.0 equals 0.0), such lookups go through a hash table
     virtual ReturnCode insert(IVector const* vector, IVector::Norm norm, double tolerance) = 0;
     virtual ReturnCode erase(IVector const* vector, IVector::Norm norm, double tolerance)  = 0;
     virtual ReturnCode erase(size_t ind) 												   = 0;
     virtual void clear() 																   = 0;
 
+    // LSH index: calls with the same norm and not greater tolerance check only index candidates,
+    // so an element within tolerance is found with probability not less than recall
+    virtual ReturnCode setApproximateIndex(IVector::Norm norm, double tolerance, double recall, size_t hashes = 8, unsigned seed = 0) = 0;
+    virtual void resetApproximateIndex() = 0;
+    // keeps elements sorted by curve key of cubic cells with side cellSize, so indices of elements change on insert;
+    // calls with tolerance not greater than cellSize check only neighbouring cells
+    virtual ReturnCode setStorageOrder(StorageOrder order, double cellSize = 1.0) = 0;
+    virtual StorageOrder getStorageOrder() const = 0;
+    // compressed formats round elements when they are stored and compare queries with the rounded coordinates as they
+    // are, so find, findBatch and erase by the inserted coordinates need tolerance above getStorageError of the norm;
+    // insert rejects points out of the format range with RC_OUT_OF_BOUNDS
+    virtual ReturnCode setStorageFormat(StorageFormat format, double step = 0) = 0;
+    virtual StorageFormat getStorageFormat() const = 0;
+    // largest distance between an element as inserted and as stored: 0 for FLOAT64, half the step per coordinate
+    // for QUANTIZED, half a float unit in the last place of the largest coordinate per axis for FLOAT32
+    virtual double getStorageError(IVector::Norm norm) const = 0;
+    // bulk transforms of all elements in place: an element brought within tolerance of an earlier one is merged
+    // into it as insert would do, compressed storage is encoded again and indexes are rebuilt once afterwards
+    virtual ReturnCode translate(IVector const* shift, IVector::Norm norm, double tolerance) = 0;
+    virtual ReturnCode scale(double factor, IVector::Norm norm, double tolerance) = 0;
+    // matrix of outDim rows by getDim() columns stored row after row, elements get dimension outDim
+    virtual ReturnCode transform(double const* matrix, size_t outDim, IVector::Norm norm, double tolerance) = 0;
+    // elements keep their coordinates along the given axes in the given order
+    virtual ReturnCode project(std::vector<size_t> const& axes, IVector::Norm norm, double tolerance) = 0;
+    // counting Bloom filter of grid cells over the widest axes: calls with tolerance not greater than the filter one
+    // skip the search for points with no element nearby, except for falsePositiveRate of them at capacity elements;
+    // the capacity is doubled when it is exceeded
+    virtual ReturnCode setBloomFilter(double tolerance, size_t capacity, double falsePositiveRate = 0.01) = 0;
+    virtual void resetBloomFilter() = 0;
+    // bytes used by the filter and probability that a point with no element nearby passes it at the current size
+    virtual ReturnCode getBloomFilterStats(size_t& memory, double& falsePositiveRate) const = 0;
+
     virtual ReturnCode find(IVector const* vector, IVector::Norm norm, double tolerance, size_t& ind) 	const = 0;
+    // find for count points stored one after another in queries, indices[i] is valid if found[i] is true
+    virtual ReturnCode findBatch(double const* queries, size_t count, IVector::Norm norm, double tolerance,
+                                 size_t* indices, bool* found) const = 0;
     virtual ReturnCode get(IVector*& dst, size_t ind) 													const = 0;
     virtual size_t getDim() 																			const = 0;
     virtual size_t getSize() 																			const = 0;
     virtual ISet* clone() 																				const = 0;
+    virtual ReturnCode save(char const* path)                                                            const = 0;
+    // per-axis minimum and maximum and mean of elements, maintained by insert and erase
+    virtual ReturnCode getBounds(IVector*& min, IVector*& max)                                           const = 0;
+    virtual ReturnCode getCentroid(IVector*& centroid)                                                   const = 0;
+    // indices of all elements lying in the compact (bounds included)
+    virtual ReturnCode queryBox(ICompact const* compact, std::vector<size_t>& indices)                   const = 0;
 
     ISet() = default;
     virtual ~ISet() = 0;
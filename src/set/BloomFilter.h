@@ -0,0 +1,177 @@
+#ifndef BLOOM_FILTER_H
+#define BLOOM_FILTER_H
+
+#include "Grid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    // counting Bloom filter of grid cells with side twice the tolerance: a ball of that tolerance
+    // touches at most two cells per axis, so a query probes at most 2^axes cells
+    class BloomFilter {
+    public:
+        // widest axes the cells are built over, more axes would need too many probes
+        static size_t const MAX_AXES = 6;
+        static size_t const MAX_HASHES = 16;
+
+        BloomFilter(double accuracy, size_t capacity, double false_positive_rate) :
+                _accuracy(accuracy),
+                _width(2 * accuracy),
+                _capacity(std::max<size_t>(capacity, 1)),
+                _false_positive_rate(false_positive_rate) {
+            resize();
+        }
+
+        double getAccuracy() const {
+            return _accuracy;
+        }
+
+        size_t getCapacity() const {
+            return _capacity;
+        }
+
+        size_t getMemory() const {
+            return _counters.size() * sizeof(uint8_t);
+        }
+
+        // probability that a query with no point nearby passes all its probes, at most one per cell it touches
+        double falsePositiveRate(size_t count) const {
+            double filled = 1.0 - std::exp(-(double)_hashes * count / _counters.size());
+            return 1.0 - std::pow(1.0 - std::pow(filled, (double)_hashes), (double)probes());
+        }
+
+        bool covers(double accuracy) const {
+            return accuracy <= _accuracy;
+        }
+
+        // counters are sized again for the new capacity, the caller adds all points back
+        void grow(size_t capacity) {
+            _capacity = std::max<size_t>(capacity, 1);
+            resize();
+        }
+
+        void clear() {
+            std::fill(_counters.begin(), _counters.end(), 0);
+        }
+
+        // cells are built over the widest axes of the bounding box, the counters are empty afterwards
+        void chooseAxes(std::vector<double> const & min, std::vector<double> const & max) {
+            widestAxes(min.data(), max.data(), min.size(), MAX_AXES, _axes);
+            resize();
+        }
+
+        void insert(double const * point) {
+            int64_t cells[MAX_AXES];
+            cellsOf(point, cells);
+            update(hashCell(cells, _axes.size()), 1);
+        }
+
+        void erase(double const * point) {
+            int64_t cells[MAX_AXES];
+            cellsOf(point, cells);
+            update(hashCell(cells, _axes.size()), -1);
+        }
+
+        // false only if no inserted point can be closer than accuracy to the given one
+        bool mayContain(double const * point, double accuracy) const {
+            size_t axes = _axes.size();
+            int64_t low[MAX_AXES], high[MAX_AXES], cells[MAX_AXES];
+            for (size_t i = 0; i < axes; i++) {
+                low[i] = cell(point[_axes[i]] - accuracy);
+                high[i] = cell(point[_axes[i]] + accuracy);
+                // rounding may stretch the range, such queries are not filtered
+                if (high[i] - low[i] > 1) {
+                    return true;
+                }
+                cells[i] = low[i];
+            }
+            while (true) {
+                if (test(hashCell(cells, axes))) {
+                    return true;
+                }
+                size_t i = 0;
+                while (i < axes && cells[i] == high[i]) {
+                    cells[i] = low[i];
+                    i++;
+                }
+                if (i == axes) {
+                    return false;
+                }
+                cells[i]++;
+            }
+        }
+
+    private:
+        // cells one query may touch
+        size_t probes() const {
+            return (size_t)1 << _axes.size();
+        }
+
+        void resize() {
+            // optimal number of counters and hashes for the capacity and the rate of one probe,
+            // chosen so that all probes of a query together pass with the false positive rate
+            double const ln2 = std::log(2.0);
+            double probe_rate = -std::expm1(std::log1p(-_false_positive_rate) / probes());
+            double size = std::ceil(-(double)_capacity * std::log(probe_rate) / (ln2 * ln2));
+            _counters.assign((size_t)std::max(size, 64.0), 0);
+            double hashes = std::round((double)_counters.size() / _capacity * ln2);
+            _hashes = (size_t)std::max(1.0, std::min((double)MAX_HASHES, hashes));
+        }
+
+        int64_t cell(double coord) const {
+            return gridCell(coord, _width);
+        }
+
+        void cellsOf(double const * point, int64_t * cells) const {
+            for (size_t i = 0; i < _axes.size(); i++) {
+                cells[i] = cell(point[_axes[i]]);
+            }
+        }
+
+        // splitmix64 finalizer over the cell numbers
+        static uint64_t hashCell(int64_t const * cells, size_t axes) {
+            uint64_t res = 0;
+            for (size_t i = 0; i < axes; i++) {
+                res += (uint64_t)cells[i] + 0x9e3779b97f4a7c15ULL;
+                res = (res ^ (res >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                res = (res ^ (res >> 27)) * 0x94d049bb133111ebULL;
+                res ^= res >> 31;
+            }
+            return res;
+        }
+
+        // double hashing: probe h = h1 + i * h2
+        void update(uint64_t hash, int delta) {
+            uint64_t step = (hash >> 32) | 1;
+            for (size_t i = 0; i < _hashes; i++) {
+                uint8_t & counter = _counters[(hash + i * step) % _counters.size()];
+                // saturated counters stay set forever, so no count is ever lost
+                if (counter != UINT8_MAX) {
+                    counter += delta;
+                }
+            }
+        }
+
+        bool test(uint64_t hash) const {
+            uint64_t step = (hash >> 32) | 1;
+            for (size_t i = 0; i < _hashes; i++) {
+                if (_counters[(hash + i * step) % _counters.size()] == 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        double _accuracy;
+        double _width;
+        size_t _capacity;
+        double _false_positive_rate;
+        size_t _hashes {1};
+        std::vector<size_t> _axes;
+        std::vector<uint8_t> _counters;
+    };
+}
+
+#endif /* BLOOM_FILTER_H */
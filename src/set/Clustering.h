@@ -0,0 +1,231 @@
+#ifndef CLUSTERING_H
+#define CLUSTERING_H
+
+#include "include/IVector.h"
+#include "Distance.h"
+#include "Grid.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+    class UnionFind {
+    public:
+        explicit UnionFind(size_t size) : _parent(size), _rank(size, 0) {
+            for (size_t i = 0; i < size; i++) {
+                _parent[i] = i;
+            }
+        }
+
+        size_t find(size_t x) {
+            while (_parent[x] != x) {
+                _parent[x] = _parent[_parent[x]];
+                x = _parent[x];
+            }
+            return x;
+        }
+
+        void unite(size_t a, size_t b) {
+            a = find(a);
+            b = find(b);
+            if (a == b) {
+                return;
+            }
+            if (_rank[a] < _rank[b]) {
+                std::swap(a, b);
+            }
+            _parent[b] = a;
+            if (_rank[a] == _rank[b]) {
+                _rank[a]++;
+            }
+        }
+
+    private:
+        std::vector<size_t> _parent;
+        std::vector<unsigned char> _rank;
+    };
+
+    // connected components of the graph linking points closer than tolerance;
+    // candidate pairs come from a grid with cells of tolerance side over a few widest axes,
+    // points closer than tolerance in any norm lie in the same or adjacent cells there
+    class ToleranceClustering {
+    public:
+        static size_t const GRID_AXES = 3;
+
+        ToleranceClustering(double const * points, size_t count, size_t dim, IVector::Norm norm, double accuracy) :
+                _points(points),
+                _count(count),
+                _dim(dim),
+                _norm(norm),
+                _accuracy(accuracy) {
+        }
+
+        void run(size_t threads) {
+            _labels.resize(_count);
+            _cluster_count = 0;
+            if (_count == 0) {
+                return;
+            }
+            UnionFind components(_count);
+            if (_accuracy == 0) {
+                linkEqual(components);
+            } else {
+                buildGrid();
+                threads = std::max<size_t>(1, std::min(threads, _count));
+                if (threads == 1) {
+                    linkRange(components, 0, _count);
+                } else {
+                    // every thread links its range of points into its own forest, forests are merged afterwards
+                    std::vector<UnionFind> forests(threads, UnionFind(_count));
+                    std::vector<std::thread> workers;
+                    for (size_t t = 0; t < threads; t++) {
+                        workers.push_back(std::thread(&ToleranceClustering::linkRange, this, std::ref(forests[t]),
+                                                      t * _count / threads, (t + 1) * _count / threads));
+                    }
+                    for (auto & worker : workers) {
+                        worker.join();
+                    }
+                    for (auto & forest : forests) {
+                        for (size_t i = 0; i < _count; i++) {
+                            components.unite(i, forest.find(i));
+                        }
+                    }
+                }
+            }
+
+            // clusters are numbered in order of their first elements
+            std::vector<size_t> root_label(_count, _count);
+            for (size_t i = 0; i < _count; i++) {
+                size_t root = components.find(i);
+                if (root_label[root] == _count) {
+                    root_label[root] = _cluster_count++;
+                }
+                _labels[i] = root_label[root];
+            }
+        }
+
+        size_t getClusterCount() const {
+            return _cluster_count;
+        }
+
+        std::vector<size_t> const & getLabels() const {
+            return _labels;
+        }
+
+        // mean of every cluster, cluster after cluster
+        void centroids(std::vector<double> & result) const {
+            result.assign(_cluster_count * _dim, 0);
+            std::vector<size_t> sizes(_cluster_count, 0);
+            for (size_t i = 0; i < _count; i++) {
+                double * sum = result.data() + _labels[i] * _dim;
+                for (size_t j = 0; j < _dim; j++) {
+                    sum[j] += _points[i * _dim + j];
+                }
+                sizes[_labels[i]]++;
+            }
+            for (size_t c = 0; c < _cluster_count; c++) {
+                for (size_t j = 0; j < _dim; j++) {
+                    result[c * _dim + j] /= sizes[c];
+                }
+            }
+        }
+
+        // element of every cluster closest to its centroid, the first one among equally close
+        void representatives(std::vector<size_t> & result) const {
+            std::vector<double> means;
+            centroids(means);
+            std::vector<double> best(_cluster_count, INFINITY);
+            result.assign(_cluster_count, 0);
+            for (size_t i = 0; i < _count; i++) {
+                size_t c = _labels[i];
+                double dist = pointDistance(_points + i * _dim, means.data() + c * _dim, _dim, _norm);
+                if (dist < best[c]) {
+                    best[c] = dist;
+                    result[c] = i;
+                }
+            }
+        }
+
+    private:
+        void buildGrid() {
+            widestAxes(_points, _count, _dim, GRID_AXES, _axes);
+
+            // (cell key, point) pairs sorted, so points of one cell are contiguous and go in index order
+            _grid.resize(_count);
+            int64_t cells[GRID_AXES];
+            for (size_t i = 0; i < _count; i++) {
+                for (size_t k = 0; k < _axes.size(); k++) {
+                    cells[k] = gridCell(_points[i * _dim + _axes[k]], _accuracy);
+                }
+                _grid[i] = std::make_pair(gridCellKey(cells, _axes.size()), i);
+            }
+            std::sort(_grid.begin(), _grid.end());
+        }
+
+        // zero tolerance links only equal points, which are adjacent in lexicographic order
+        void linkEqual(UnionFind & forest) {
+            std::vector<size_t> order(_count);
+            for (size_t i = 0; i < _count; i++) {
+                order[i] = i;
+            }
+            double const * points = _points;
+            size_t dim = _dim;
+            std::sort(order.begin(), order.end(), [points, dim](size_t a, size_t b) {
+                return std::lexicographical_compare(points + a * dim, points + (a + 1) * dim, points + b * dim, points + (b + 1) * dim);
+            });
+            for (size_t k = 1; k < _count; k++) {
+                if (pointsEqual(_points + order[k - 1] * _dim, _points + order[k] * _dim, _dim, _norm, 0)) {
+                    forest.unite(order[k - 1], order[k]);
+                }
+            }
+        }
+
+        // links every point of the range with preceding points closer than tolerance
+        void linkRange(UnionFind & forest, size_t begin, size_t end) {
+            size_t axes = _axes.size();
+            size_t neighbours = 1;
+            for (size_t k = 0; k < axes; k++) {
+                neighbours *= 3;
+            }
+            int64_t center[GRID_AXES], cells[GRID_AXES];
+            for (size_t i = begin; i < end; i++) {
+                double const * cur = _points + i * _dim;
+                for (size_t k = 0; k < axes; k++) {
+                    center[k] = gridCell(cur[_axes[k]], _accuracy);
+                }
+                for (size_t n = 0; n < neighbours; n++) {
+                    size_t code = n;
+                    for (size_t k = 0; k < axes; k++) {
+                        cells[k] = center[k] + (int64_t)(code % 3) - 1;
+                        code /= 3;
+                    }
+                    uint64_t key = gridCellKey(cells, axes);
+                    auto it = std::lower_bound(_grid.begin(), _grid.end(), std::make_pair(key, (size_t)0));
+                    for (; it != _grid.end() && it->first == key && it->second < i; ++it) {
+                        size_t other = it->second;
+                        // distance is computed only for points not linked yet
+                        if (forest.find(other) != forest.find(i) &&
+                                pointsEqual(_points + other * _dim, cur, _dim, _norm, _accuracy)) {
+                            forest.unite(other, i);
+                        }
+                    }
+                }
+            }
+        }
+
+        double const * _points;
+        size_t _count;
+        size_t _dim;
+        IVector::Norm _norm;
+        double _accuracy;
+        std::vector<size_t> _axes;
+        std::vector<std::pair<uint64_t, size_t>> _grid;
+        std::vector<size_t> _labels;
+        size_t _cluster_count {0};
+    };
+}
+
+#endif /* CLUSTERING_H */
@@ -0,0 +1,105 @@
+#ifndef COLLAPSE_H
+#define COLLAPSE_H
+
+#include "include/IVector.h"
+#include "Distance.h"
+#include "ExactIndex.h"
+#include "Grid.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // drops every point within tolerance of an earlier kept one, as inserting the points one by one would;
+    // kept points are hashed by cells of tolerance side over a few widest axes, so a point is compared
+    // only with kept points of the neighbouring cells, which are few as they are farther than tolerance apart
+    class CollapseFilter {
+    public:
+        static size_t const GRID_AXES = 3;
+
+        CollapseFilter(size_t dim, IVector::Norm norm, double accuracy) : _dim(dim), _norm(norm), _accuracy(accuracy) {
+        }
+
+        // kept points are moved to the beginning in their order, returns their count
+        size_t run(double * points, size_t count) {
+            if (count == 0) {
+                return 0;
+            }
+            if (_accuracy == 0) {
+                return runExact(points, count);
+            }
+            widestAxes(points, count, _dim, GRID_AXES, _axes);
+
+            std::unordered_map<uint64_t, std::vector<size_t>> grid;
+            size_t axes = _axes.size();
+            size_t neighbours = 1;
+            for (size_t k = 0; k < axes; k++) {
+                neighbours *= 3;
+            }
+            int64_t center[GRID_AXES], cells[GRID_AXES];
+            size_t kept = 0;
+            for (size_t i = 0; i < count; i++) {
+                double const * cur = points + i * _dim;
+                for (size_t k = 0; k < axes; k++) {
+                    center[k] = gridCell(cur[_axes[k]], _accuracy);
+                }
+                bool close = false;
+                for (size_t n = 0; n < neighbours && !close; n++) {
+                    size_t code = n;
+                    for (size_t k = 0; k < axes; k++) {
+                        cells[k] = center[k] + (int64_t)(code % 3) - 1;
+                        code /= 3;
+                    }
+                    auto it = grid.find(gridCellKey(cells, axes));
+                    if (it == grid.end()) {
+                        continue;
+                    }
+                    for (auto other : it->second) {
+                        if (pointsEqual(points + other * _dim, cur, _dim, _norm, _accuracy)) {
+                            close = true;
+                            break;
+                        }
+                    }
+                }
+                if (!close) {
+                    keep(points, i, kept);
+                    grid[gridCellKey(center, axes)].push_back(kept++);
+                }
+            }
+            return kept;
+        }
+
+    private:
+        // kept points never move forward, so the copy does not overwrite a point still to be checked
+        void keep(double * points, size_t from, size_t to) const {
+            if (from != to) {
+                std::copy(points + from * _dim, points + (from + 1) * _dim, points + to * _dim);
+            }
+        }
+
+        size_t runExact(double * points, size_t count) {
+            ExactIndex index(_dim);
+            size_t kept = 0, ind = 0;
+            for (size_t i = 0; i < count; i++) {
+                double const * cur = points + i * _dim;
+                uint64_t key = ExactIndex::hash(cur, _dim);
+                bool equal = index.find(key, [this, points, cur](size_t id) {
+                    return pointsEqual(points + id * _dim, cur, _dim, IVector::Norm::NORM_INF, 0);
+                }, ind);
+                if (!equal) {
+                    keep(points, i, kept);
+                    index.insert(key, kept++);
+                }
+            }
+            return kept;
+        }
+
+        size_t _dim;
+        IVector::Norm _norm;
+        double _accuracy;
+        std::vector<size_t> _axes;
+    };
+}
+
+#endif /* COLLAPSE_H */
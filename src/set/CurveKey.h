@@ -0,0 +1,104 @@
+#ifndef CURVE_KEY_H
+#define CURVE_KEY_H
+
+#include "include/ISet.h"
+#include "Grid.h"
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    // key of a point on the Morton or Hilbert curve over a grid with cubic cells;
+    // cell numbers are wrapped to the bits available per axis, so equal keys do not imply equal cells
+    class CurveKey {
+    public:
+        static size_t const KEY_BITS = 64;
+
+        CurveKey(size_t dim, ISet::StorageOrder order, double cell_size) :
+                _order(order),
+                _cell_size(cell_size),
+                _axes(dim < KEY_BITS ? dim : KEY_BITS),
+                _bits(std::min<size_t>(KEY_BITS / _axes, 31)) {
+        }
+
+        ISet::StorageOrder getOrder() const {
+            return _order;
+        }
+
+        double getCellSize() const {
+            return _cell_size;
+        }
+
+        // number of leading axes the key depends on
+        size_t getAxes() const {
+            return _axes;
+        }
+
+        int64_t cell(double coord) const {
+            return gridCell(coord, _cell_size);
+        }
+
+        uint64_t key(double const * point) const {
+            int64_t cells[KEY_BITS];
+            for (size_t i = 0; i < _axes; i++) {
+                cells[i] = cell(point[i]);
+            }
+            return key(cells);
+        }
+
+        uint64_t key(int64_t const * cells) const {
+            uint64_t coords[KEY_BITS];
+            uint64_t mask = (1ULL << _bits) - 1;
+            for (size_t i = 0; i < _axes; i++) {
+                coords[i] = (uint64_t)cells[i] & mask;
+            }
+            if (_order == ISet::StorageOrder::HILBERT) {
+                toHilbertTranspose(coords);
+            }
+            uint64_t res = 0;
+            for (size_t bit = _bits; bit > 0; bit--) {
+                for (size_t i = 0; i < _axes; i++) {
+                    res = (res << 1) | ((coords[i] >> (bit - 1)) & 1);
+                }
+            }
+            return res;
+        }
+
+    private:
+        // J. Skilling, "Programming the Hilbert curve": interleaving the transposed coordinates gives the Hilbert index
+        void toHilbertTranspose(uint64_t * x) const {
+            uint64_t m = 1ULL << (_bits - 1);
+            for (uint64_t q = m; q > 1; q >>= 1) {
+                uint64_t p = q - 1;
+                for (size_t i = 0; i < _axes; i++) {
+                    if (x[i] & q) {
+                        x[0] ^= p;
+                    } else {
+                        uint64_t t = (x[0] ^ x[i]) & p;
+                        x[0] ^= t;
+                        x[i] ^= t;
+                    }
+                }
+            }
+            for (size_t i = 1; i < _axes; i++) {
+                x[i] ^= x[i - 1];
+            }
+            uint64_t t = 0;
+            for (uint64_t q = m; q > 1; q >>= 1) {
+                if (x[_axes - 1] & q) {
+                    t ^= q - 1;
+                }
+            }
+            for (size_t i = 0; i < _axes; i++) {
+                x[i] ^= t;
+            }
+        }
+
+        ISet::StorageOrder _order;
+        double _cell_size;
+        size_t _axes;
+        size_t _bits;
+    };
+}
+
+#endif /* CURVE_KEY_H */
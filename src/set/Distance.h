@@ -0,0 +1,68 @@
+#ifndef DISTANCE_H
+#define DISTANCE_H
+
+#include "include/IVector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace {
+    // norm of (a - b) like IVector::equals computes it, but without allocations;
+    // four independent accumulators let the compiler vectorize the loops
+    inline double pointDistance(double const * a, double const * b, size_t dim, IVector::Norm norm) {
+        double acc[4] = {0, 0, 0, 0};
+        size_t i = 0;
+        switch (norm) {
+            case IVector::Norm::NORM_1:
+                for (; i + 4 <= dim; i += 4) {
+                    for (size_t k = 0; k < 4; k++) {
+                        acc[k] += std::fabs(a[i + k] - b[i + k]);
+                    }
+                }
+                for (; i < dim; ++i) {
+                    acc[0] += std::fabs(a[i] - b[i]);
+                }
+                return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+            case IVector::Norm::NORM_2:
+                for (; i + 4 <= dim; i += 4) {
+                    for (size_t k = 0; k < 4; k++) {
+                        double diff = a[i + k] - b[i + k];
+                        acc[k] += diff * diff;
+                    }
+                }
+                for (; i < dim; ++i) {
+                    double diff = a[i] - b[i];
+                    acc[0] += diff * diff;
+                }
+                return std::sqrt((acc[0] + acc[1]) + (acc[2] + acc[3]));
+            case IVector::Norm::NORM_INF:
+                for (; i + 4 <= dim; i += 4) {
+                    for (size_t k = 0; k < 4; k++) {
+                        double diff = std::fabs(a[i + k] - b[i + k]);
+                        acc[k] = acc[k] < diff ? diff : acc[k];
+                    }
+                }
+                for (; i < dim; ++i) {
+                    double diff = std::fabs(a[i] - b[i]);
+                    acc[0] = acc[0] < diff ? diff : acc[0];
+                }
+                return std::max(std::max(acc[0], acc[1]), std::max(acc[2], acc[3]));
+        }
+        return 0;
+    }
+
+    // zero tolerance means exact equality of coordinates
+    inline bool pointsEqual(double const * a, double const * b, size_t dim, IVector::Norm norm, double accuracy) {
+        if (accuracy == 0) {
+            return std::equal(a, a + dim, b);
+        }
+        return pointDistance(a, b, dim, norm) < accuracy;
+    }
+
+    // points whose coordinates along one axis differ by diff are not equal under the tolerance
+    inline bool beyondTolerance(double diff, double accuracy) {
+        return accuracy == 0 ? diff > 0 : diff >= accuracy;
+    }
+}
+
+#endif /* DISTANCE_H */
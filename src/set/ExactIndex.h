@@ -0,0 +1,128 @@
+#ifndef EXACT_INDEX_H
+#define EXACT_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+    // open addressing hash table from the hash of coordinates to element ids, answers zero tolerance lookups
+    class ExactIndex {
+    public:
+        explicit ExactIndex(size_t dim) : _dim(dim), _slots(MIN_SLOTS, Slot{0, EMPTY}) {
+        }
+
+        // four independent lanes over the coordinate bits, so the loop is vectorized like the distance kernel;
+        // -0.0 is hashed as 0.0 because they compare equal
+        static uint64_t hash(double const * point, size_t dim) {
+            uint64_t lanes[4] = {0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL, 0xa4093822299f31d0ULL, 0x082efa98ec4e6c89ULL};
+            size_t i = 0;
+            for (; i + 4 <= dim; i += 4) {
+                for (size_t k = 0; k < 4; k++) {
+                    lanes[k] = (lanes[k] ^ bits(point[i + k])) * 0x9e3779b97f4a7c15ULL;
+                }
+            }
+            for (; i < dim; i++) {
+                lanes[0] = (lanes[0] ^ bits(point[i])) * 0x9e3779b97f4a7c15ULL;
+            }
+            uint64_t res = lanes[0] ^ (lanes[1] >> 17) ^ (lanes[2] << 23) ^ (lanes[3] >> 41) ^ dim;
+            res = (res ^ (res >> 31)) * 0xbf58476d1ce4e5b9ULL;
+            return res ^ (res >> 29);
+        }
+
+        void insert(uint64_t key, size_t id) {
+            if (2 * (_size + _removed + 1) > _slots.size()) {
+                rehash(4 * (_size + 1));
+            }
+            size_t mask = _slots.size() - 1;
+            for (size_t pos = key & mask; ; pos = (pos + 1) & mask) {
+                if (_slots[pos].id == EMPTY || _slots[pos].id == REMOVED) {
+                    _removed -= _slots[pos].id == REMOVED ? 1 : 0;
+                    _slots[pos].key = key;
+                    _slots[pos].id = id;
+                    _size++;
+                    return;
+                }
+            }
+        }
+
+        // removes id, ids after it are shifted down like in the set storage
+        void erase(uint64_t key, size_t id) {
+            size_t mask = _slots.size() - 1;
+            for (size_t pos = key & mask; _slots[pos].id != EMPTY; pos = (pos + 1) & mask) {
+                if (_slots[pos].id == id) {
+                    _slots[pos].id = REMOVED;
+                    _size--;
+                    _removed++;
+                    break;
+                }
+            }
+            for (auto & slot : _slots) {
+                slot.id -= slot.id > id && slot.id < REMOVED ? 1 : 0;
+            }
+        }
+
+        // makes room for an element inserted with given id in the middle of the set storage
+        void shiftFrom(size_t id) {
+            for (auto & slot : _slots) {
+                slot.id += slot.id >= id && slot.id < REMOVED ? 1 : 0;
+            }
+        }
+
+        // smallest id with given key for which equal(id) holds
+        template <class Equal>
+        bool find(uint64_t key, Equal equal, size_t & ind) const {
+            size_t mask = _slots.size() - 1;
+            bool found = false;
+            for (size_t pos = key & mask; _slots[pos].id != EMPTY; pos = (pos + 1) & mask) {
+                Slot const & slot = _slots[pos];
+                if (slot.key == key && slot.id != REMOVED && (!found || slot.id < ind) && equal(slot.id)) {
+                    ind = slot.id;
+                    found = true;
+                }
+            }
+            return found;
+        }
+
+    private:
+        static size_t const MIN_SLOTS = 16;
+        static size_t const EMPTY = (size_t)-1;
+        static size_t const REMOVED = (size_t)-2;
+
+        struct Slot {
+            uint64_t key;
+            size_t id;
+        };
+
+        static uint64_t bits(double coord) {
+            coord += 0.0;
+            uint64_t res;
+            std::memcpy(&res, &coord, sizeof(res));
+            return res;
+        }
+
+        void rehash(size_t min_slots) {
+            size_t size = MIN_SLOTS;
+            while (size < min_slots) {
+                size *= 2;
+            }
+            std::vector<Slot> old(size, Slot{0, EMPTY});
+            old.swap(_slots);
+            _size = 0;
+            _removed = 0;
+            for (auto const & slot : old) {
+                if (slot.id != EMPTY && slot.id != REMOVED) {
+                    insert(slot.key, slot.id);
+                }
+            }
+        }
+
+        size_t _dim;
+        std::vector<Slot> _slots;
+        size_t _size {0};
+        size_t _removed {0};
+    };
+}
+
+#endif /* EXACT_INDEX_H */
@@ -0,0 +1,56 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace {
+    // number of the cell of a grid with the given side, clamped so that neighbours of any cell still fit in int64_t
+    inline int64_t gridCell(double coord, double side) {
+        double const limit = 4611686018427387904.0; // 2^62
+        double cell = std::floor(coord / side);
+        return (int64_t)std::max(-limit, std::min(limit, cell));
+    }
+
+    inline uint64_t gridCellKey(int64_t const * cells, size_t axes) {
+        uint64_t res = 0;
+        for (size_t k = 0; k < axes; k++) {
+            res ^= (uint64_t)cells[k] + 0x9e3779b97f4a7c15ULL + (res << 6) + (res >> 2);
+        }
+        return res;
+    }
+
+    // at most max_axes axes with the widest range max - min, the widest first;
+    // a grid over them splits the points into the most cells
+    inline void widestAxes(double const * min, double const * max, size_t dim, size_t max_axes,
+                           std::vector<size_t> & axes) {
+        std::vector<std::pair<double, size_t>> spread(dim);
+        for (size_t j = 0; j < dim; j++) {
+            spread[j] = std::make_pair(-(max[j] - min[j]), j);
+        }
+        std::sort(spread.begin(), spread.end());
+        axes.clear();
+        for (size_t k = 0; k < dim && k < max_axes; k++) {
+            axes.push_back(spread[k].second);
+        }
+    }
+
+    // same for the range of count points stored one after another
+    inline void widestAxes(double const * points, size_t count, size_t dim, size_t max_axes,
+                           std::vector<size_t> & axes) {
+        std::vector<double> min(points, points + dim), max(points, points + dim);
+        for (size_t i = 1; i < count; i++) {
+            for (size_t j = 0; j < dim; j++) {
+                min[j] = std::min(min[j], points[i * dim + j]);
+                max[j] = std::max(max[j], points[i * dim + j]);
+            }
+        }
+        widestAxes(min.data(), max.data(), dim, max_axes, axes);
+    }
+}
+
+#endif /* GRID_H */
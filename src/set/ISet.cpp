@@ -1,5 +1,9 @@
 #include "include/ISet.h"
 #include "ISetImpl.cpp"
+#include "Clustering.h"
+#include "Join.h"
+#include "Reduce.h"
+#include "StreamDedup.h"
 
 static ReturnCode validateSets(ISet const * set1, ISet const * set2, double accuracy) {
     if (set1 == nullptr || set2 == nullptr) {
@@ -27,12 +31,24 @@ ISet * ISet::createSet(ILogger * logger) {
     return set;
 }
 
+ISet * ISet::openMapped(char const * path, ILogger * logger) {
+    return ISetImpl::openMapped(path, logger);
+}
+
 ISet * ISet::_union(ISet const * set1, ISet const * set2, IVector::Norm norm, double accuracy, ILogger * logger) {
     ReturnCode r_code = validateSets(set1, set2, accuracy);
     if (r_code != ReturnCode::RC_SUCCESS) {
         LOG(logger, r_code);
         return nullptr;
     }
+    // sets sorted by the same curve key are merged instead of inserting elements one by one
+    if (ISetImpl::sameOrder(set1, set2, accuracy)) {
+        ISet * union_set = ISetImpl::unionOrdered(set1, set2, norm, accuracy);
+        if (union_set == nullptr) {
+            LOG(logger, ReturnCode::RC_NO_MEM);
+        }
+        return union_set;
+    }
 
     ISet * union_set = set1->clone();
     IVector * cur_vec = nullptr;
@@ -93,6 +109,13 @@ ISet * ISet::intersection(ISet const * set1, ISet const * set2, IVector::Norm no
         LOG(logger, r_code);
         return nullptr;
     }
+    if (ISetImpl::sameOrder(set1, set2, accuracy)) {
+        ISet * inter_set = ISetImpl::intersectionOrdered(set1, set2, norm, accuracy);
+        if (inter_set == nullptr) {
+            LOG(logger, ReturnCode::RC_NO_MEM);
+        }
+        return inter_set;
+    }
     ISet * inter_set = ISet::createSet(logger);
     if (inter_set == nullptr) {
         LOG(logger, ReturnCode::RC_NO_MEM);
@@ -125,4 +148,341 @@ ISet * ISet::intersection(ISet const * set1, ISet const * set2, IVector::Norm no
     return inter_set;
 }
 
+// coordinates of all elements one after another, copied only for sets which do not keep them so
+static double const * setPoints(ISet const * set, std::vector<double> & copy) {
+    ISetImpl const * impl = dynamic_cast<ISetImpl const *>(set);
+    if (impl != nullptr && impl->data() != nullptr) {
+        return impl->data();
+    }
+    if (impl != nullptr) {
+        impl->decodeAll(copy);
+        return copy.data();
+    }
+    copy.clear();
+    for (size_t ind = 0; ind < set->getSize(); ind++) {
+        IVector * vec = nullptr;
+        if (set->get(vec, ind) != ReturnCode::RC_SUCCESS) {
+            return nullptr;
+        }
+        for (size_t i = 0; i < vec->getDim(); i++) {
+            copy.push_back(vec->getCoord(i));
+        }
+        delete vec;
+    }
+    return copy.data();
+}
+
+static ReturnCode runClustering(ToleranceClustering *& clustering, std::vector<double> & copy, ISet const * set,
+                                IVector::Norm norm, double accuracy, size_t threads) {
+    if (set == nullptr) {
+        return ReturnCode::RC_NULL_PTR;
+    }
+    if (std::isnan(accuracy) || accuracy < 0) {
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    double const * points = setPoints(set, copy);
+    if (points == nullptr && set->getSize() != 0) {
+        return ReturnCode::RC_NO_MEM;
+    }
+    clustering = new(std::nothrow) ToleranceClustering(points, set->getSize(), set->getDim(), norm, accuracy);
+    if (clustering == nullptr) {
+        return ReturnCode::RC_NO_MEM;
+    }
+    clustering->run(workerCount(threads, set->getSize()));
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISet::cluster(ISet const * set, IVector::Norm norm, double accuracy, std::vector<size_t> & labels,
+                         size_t & clusterCount, size_t threads, ILogger * logger) {
+    ToleranceClustering * clustering = nullptr;
+    std::vector<double> copy;
+    ReturnCode r_code = runClustering(clustering, copy, set, norm, accuracy, threads);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+        return r_code;
+    }
+    labels = clustering->getLabels();
+    clusterCount = clustering->getClusterCount();
+    delete clustering;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISet::clusterSummary(ISet const * set, IVector::Norm norm, double accuracy, ClusterSummary summary,
+                                std::vector<double> & points, size_t threads, ILogger * logger) {
+    ToleranceClustering * clustering = nullptr;
+    std::vector<double> copy;
+    ReturnCode r_code = runClustering(clustering, copy, set, norm, accuracy, threads);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+        return r_code;
+    }
+
+    points.clear();
+    if (summary == ClusterSummary::CENTROIDS) {
+        clustering->centroids(points);
+    } else {
+        std::vector<size_t> representatives;
+        clustering->representatives(representatives);
+        double const * coords = setPoints(set, copy);
+        for (auto ind : representatives) {
+            points.insert(points.end(), coords + ind * set->getDim(), coords + (ind + 1) * set->getDim());
+        }
+    }
+    delete clustering;
+    return ReturnCode::RC_SUCCESS;
+}
+
+// coordinates of a non-empty set for the reductions
+static ReturnCode reductionPoints(ISet const * set, std::vector<double> & copy, double const *& points) {
+    if (set == nullptr) {
+        return ReturnCode::RC_NULL_PTR;
+    }
+    if (set->getSize() == 0) {
+        return ReturnCode::RC_ZERO_DIM;
+    }
+    points = setPoints(set, copy);
+    return points == nullptr ? ReturnCode::RC_NO_MEM : ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISet::statistics(ISet const * set, std::vector<double> & min, std::vector<double> & max, std::vector<double> & mean,
+                            std::vector<double> & covariance, size_t threads, ILogger * logger) {
+    std::vector<double> copy;
+    double const * points = nullptr;
+    ReturnCode r_code = reductionPoints(set, copy, points);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+        return r_code;
+    }
+
+    size_t count = set->getSize(), dim = set->getDim();
+    std::vector<Moments> partials(workerCount(threads, count), Moments(dim, points));
+    reduceRanges(count, partials.size(), partials, [points](Moments & partial, size_t begin, size_t end) {
+        partial.add(points, begin, end);
+    });
+    for (size_t t = 1; t < partials.size(); t++) {
+        partials[0].merge(partials[t]);
+    }
+    partials[0].result(min, max, mean, covariance);
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISet::axisHistograms(ISet const * set, size_t bins, std::vector<size_t> & counts, size_t threads, ILogger * logger) {
+    if (bins == 0) {
+        LOG(logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    std::vector<double> copy;
+    double const * points = nullptr;
+    ReturnCode r_code = reductionPoints(set, copy, points);
+    IVector * min = nullptr;
+    IVector * max = nullptr;
+    if (r_code == ReturnCode::RC_SUCCESS) {
+        r_code = set->getBounds(min, max);
+    }
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+        return r_code;
+    }
+
+    size_t count = set->getSize(), dim = set->getDim();
+    std::vector<double> low(dim), high(dim);
+    for (size_t i = 0; i < dim; i++) {
+        low[i] = min->getCoord(i);
+        high[i] = max->getCoord(i);
+    }
+    delete min;
+    delete max;
+    std::vector<std::vector<size_t>> partials(workerCount(threads, count), std::vector<size_t>(dim * bins, 0));
+    reduceRanges(count, partials.size(), partials, [&](std::vector<size_t> & partial, size_t begin, size_t end) {
+        for (size_t ind = begin; ind < end; ind++) {
+            for (size_t i = 0; i < dim; i++) {
+                partial[i * bins + histogramBin(points[ind * dim + i], low[i], high[i], bins)]++;
+            }
+        }
+    });
+    counts.assign(dim * bins, 0);
+    for (auto const & partial : partials) {
+        for (size_t k = 0; k < counts.size(); k++) {
+            counts[k] += partial[k];
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISet::normHistogram(ISet const * set, IVector::Norm norm, size_t bins, std::vector<size_t> & counts,
+                               double & maxNorm, size_t threads, ILogger * logger) {
+    if (bins == 0) {
+        LOG(logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    std::vector<double> copy;
+    double const * points = nullptr;
+    ReturnCode r_code = reductionPoints(set, copy, points);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+        return r_code;
+    }
+
+    // norms are computed once, the largest of them bounds the bins
+    size_t count = set->getSize(), dim = set->getDim();
+    std::vector<double> norms(count);
+    std::vector<double> zero(dim, 0);
+    size_t workers = workerCount(threads, count);
+    std::vector<double> largest(workers, 0);
+    reduceRanges(count, workers, largest, [&](double & partial, size_t begin, size_t end) {
+        for (size_t ind = begin; ind < end; ind++) {
+            norms[ind] = pointDistance(points + ind * dim, zero.data(), dim, norm);
+            partial = std::max(partial, norms[ind]);
+        }
+    });
+    maxNorm = *std::max_element(largest.begin(), largest.end());
+
+    std::vector<std::vector<size_t>> partials(workers, std::vector<size_t>(bins, 0));
+    reduceRanges(count, workers, partials, [&](std::vector<size_t> & partial, size_t begin, size_t end) {
+        for (size_t ind = begin; ind < end; ind++) {
+            partial[histogramBin(norms[ind], 0, maxNorm, bins)]++;
+        }
+    });
+    counts.assign(bins, 0);
+    for (auto const & partial : partials) {
+        for (size_t k = 0; k < bins; k++) {
+            counts[k] += partial[k];
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISet::selfJoin(double const * points, size_t count, size_t dim, IVector::Norm norm, double accuracy,
+                          PushPairs push, void * pushContext, size_t & pairCount, ILogger * logger) {
+    pairCount = 0;
+    if ((points == nullptr && count != 0) || push == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    if (dim == 0 && count != 0) {
+        LOG(logger, ReturnCode::RC_ZERO_DIM);
+        return ReturnCode::RC_ZERO_DIM;
+    }
+    if (std::isnan(accuracy) || accuracy < 0) {
+        LOG(logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+
+    ToleranceJoin tolerance_join(dim, norm, accuracy, push, pushContext);
+    ReturnCode r_code = tolerance_join.selfJoin(points, count);
+    pairCount = tolerance_join.getPairCount();
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+    }
+    return r_code;
+}
+
+ReturnCode ISet::selfJoin(ISet const * set, IVector::Norm norm, double accuracy, PushPairs push, void * pushContext,
+                          size_t & pairCount, ILogger * logger) {
+    pairCount = 0;
+    if (set == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    std::vector<double> copy;
+    double const * points = setPoints(set, copy);
+    if (points == nullptr && set->getSize() != 0) {
+        LOG(logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    return selfJoin(points, set->getSize(), set->getDim(), norm, accuracy, push, pushContext, pairCount, logger);
+}
+
+static ReturnCode collectPairs(void * context, size_t const * pairs, size_t count) {
+    std::vector<size_t> * result = (std::vector<size_t> *)context;
+    result->insert(result->end(), pairs, pairs + 2 * count);
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISet::selfJoin(ISet const * set, IVector::Norm norm, double accuracy, std::vector<size_t> & pairs, ILogger * logger) {
+    pairs.clear();
+    size_t pair_count;
+    return selfJoin(set, norm, accuracy, collectPairs, &pairs, pair_count, logger);
+}
+
+ReturnCode ISet::join(ISet const * set1, ISet const * set2, IVector::Norm norm, double accuracy, PushPairs push, void * pushContext,
+                      size_t & pairCount, ILogger * logger) {
+    pairCount = 0;
+    if (push == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    ReturnCode r_code = validateSets(set1, set2, accuracy);
+    // a pair needs elements in both sets
+    if (r_code == ReturnCode::RC_ZERO_DIM && set1 != nullptr && set2 != nullptr) {
+        return ReturnCode::RC_SUCCESS;
+    }
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+        return r_code;
+    }
+
+    std::vector<double> copy1, copy2;
+    double const * points1 = setPoints(set1, copy1);
+    double const * points2 = setPoints(set2, copy2);
+    if (points1 == nullptr || points2 == nullptr) {
+        LOG(logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    ToleranceJoin tolerance_join(set1->getDim(), norm, accuracy, push, pushContext);
+    r_code = tolerance_join.join(points1, set1->getSize(), points2, set2->getSize());
+    pairCount = tolerance_join.getPairCount();
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+    }
+    return r_code;
+}
+
+ReturnCode ISet::dedupStream(size_t dim, PullPoints pull, void * pullContext, PushPoints push, void * pushContext,
+                             IVector::Norm norm, double accuracy, size_t memoryBudget, size_t & resultSize, ILogger * logger) {
+    resultSize = 0;
+    if (pull == nullptr || push == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    if (dim == 0) {
+        LOG(logger, ReturnCode::RC_ZERO_DIM);
+        return ReturnCode::RC_ZERO_DIM;
+    }
+    if (std::isnan(accuracy) || accuracy < 0) {
+        LOG(logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+
+    StreamDedup dedup(dim, norm, accuracy, memoryBudget, push, pushContext);
+    ReturnCode r_code = dedup.run(pull, pullContext, resultSize);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(logger, r_code);
+    }
+    return r_code;
+}
+
+namespace {
+    struct FileSource {
+        FILE * file;
+        size_t dim;
+    };
+}
+
+static size_t pullFromFile(void * context, double * buffer, size_t maxCount) {
+    FileSource * source = (FileSource *)context;
+    return fread(buffer, sizeof(double) * source->dim, maxCount, source->file);
+}
+
+ReturnCode ISet::dedupStream(size_t dim, FILE * input, PushPoints push, void * pushContext,
+                             IVector::Norm norm, double accuracy, size_t memoryBudget, size_t & resultSize, ILogger * logger) {
+    if (input == nullptr) {
+        resultSize = 0;
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    FileSource source = {input, dim};
+    return dedupStream(dim, pullFromFile, &source, push, pushContext, norm, accuracy, memoryBudget, resultSize, logger);
+}
+
 ISet::~ISet() {}
\ No newline at end of file
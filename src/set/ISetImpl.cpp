@@ -1,6 +1,21 @@
 #include "include/ISet.h"
+#include "include/ICompact.h"
+#include "BloomFilter.h"
+#include "Collapse.h"
+#include "CurveKey.h"
+#include "ExactIndex.h"
+#include "Distance.h"
+#include "LSHIndex.h"
+#include "MappedFile.h"
+#include "PackedPoints.h"
+#include "Snapshot.h"
+#include <stdio.h>
 #include <stdlib.h>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <mutex>
+#include <numeric>
 #include <vector>
 
 static ReturnCode validateVector(const IVector * vec) {
@@ -21,22 +36,118 @@ static ReturnCode validateVector(const IVector * vec) {
 namespace {
     class ISetImpl : public ISet {
     private:
+        static size_t const BATCH_SORT_MIN = 16;
+        // more neighbouring cells are slower to probe than to scan the set
+        static size_t const CELL_PROBE_LIMIT = 256;
+
         size_t _dim {0};
-        std::vector<IVector *> _data;
+        // coordinates of all elements one after another
+        std::vector<double> _data;
         ILogger * _logger {nullptr};
 
+        // compressed formats keep coordinates in _packed instead of _data
+        StorageFormat _format {StorageFormat::FLOAT64};
+        double _step {0};
+        PackedPoints * _packed {nullptr};
+
+        bool _lsh_enabled {false};
+        IVector::Norm _lsh_norm {IVector::Norm::NORM_2};
+        double _lsh_accuracy {0};
+        double _lsh_recall {0};
+        size_t _lsh_hashes {0};
+        unsigned _lsh_seed {0};
+        LSHIndex * _lsh {nullptr};
+
+        StorageOrder _order {StorageOrder::INSERTION};
+        double _cell_size {1.0};
+        CurveKey * _curve {nullptr};
+        // curve keys of elements, sorted together with the storage
+        std::vector<uint64_t> _keys;
+
+        BloomFilter * _bloom {nullptr};
+        // hash table for zero tolerance lookups, built by the first of them
+        mutable ExactIndex * _exact {nullptr};
+        mutable std::atomic<bool> _exact_ready {false};
+
+        // set opened by openMapped reads coordinates from the file until the first modification
+        MappedFile * _mapping {nullptr};
+        double const * _mapped_data {nullptr};
+        size_t _mapped_size {0};
+
+        // per-axis bounds and sum of elements, recomputed lazily after an erase touching the bounds
+        mutable std::atomic<bool> _stats_valid {false};
+        mutable std::vector<double> _min;
+        mutable std::vector<double> _max;
+        mutable std::vector<double> _sum;
+        // const lookups may run in several threads at once, the first of them builds the lazy state under the lock
+        mutable std::mutex _lazy_mutex;
+
+        double const * point(size_t ind, double * buffer) const;
+        void storePoint(size_t pos, double const * coords);
+        ReturnCode buildPacked(double const * origin);
+        ReturnCode replacePoints(size_t dim, std::vector<double> & points, StorageFormat format, double step,
+                                 CollapseFilter * collapse);
+        ReturnCode applyTransform(size_t dim, std::vector<double> & points, IVector::Norm norm, double accuracy);
+        bool checkTransform(double accuracy) const;
+        void updateStats() const;
+        bool outsideBounds(double const * coords, double accuracy) const;
+        void detach();
+        void loadVector(IVector const * vector, std::vector<double> & coords) const;
+        bool findPoint(double const * coords, IVector::Norm norm, double accuracy, size_t & ind) const;
+        bool findInCells(double const * coords, IVector::Norm norm, double accuracy, size_t & ind, bool & found) const;
+        void insertPoint(double const * coords);
+        ReturnCode buildIndex();
+        ReturnCode buildCurve();
+        void fillBloomFilter();
+        void buildExactIndex() const;
+        void resetExactIndex() const;
+        ISetImpl * createLike() const;
+        ISetImpl * selectOrdered(ISetImpl const * other, bool within, ISetImpl const * exclude,
+                                 IVector::Norm norm, double accuracy) const;
+        ISetImpl * mergeOrdered(ISetImpl const * other) const;
+        ReturnCode loadIndex(SnapshotHeader const & header, char const * base);
+
     public:
+        static ISet * openMapped(char const * path, ILogger * logger);
+        // coordinates of all elements one after another, nullptr for compressed storage
+        double const * data() const;
+        void decodeAll(std::vector<double> & points) const;
+        // sets ordered by the same curve over the same cells, fine enough for the tolerance
+        static bool sameOrder(ISet const * set1, ISet const * set2, double accuracy);
+        static ISet * unionOrdered(ISet const * set1, ISet const * set2, IVector::Norm norm, double accuracy);
+        static ISet * intersectionOrdered(ISet const * set1, ISet const * set2, IVector::Norm norm, double accuracy);
+
         ISetImpl();
 
         ReturnCode insert(IVector const * vector, IVector::Norm norm, double accuracy)  override;
         ReturnCode erase(IVector const * vector, IVector::Norm norm, double accuracy) 	override;
         ReturnCode erase(size_t index) 													override;
         void clear() 																	override;
+        ReturnCode setApproximateIndex(IVector::Norm norm, double accuracy, double recall, size_t hashes, unsigned seed) override;
+        void resetApproximateIndex()                                                   override;
+        ReturnCode setStorageOrder(StorageOrder order, double cellSize)                override;
+        StorageOrder getStorageOrder()                                           const override;
+        ReturnCode setStorageFormat(StorageFormat format, double step)                 override;
+        StorageFormat getStorageFormat()                                         const override;
+        double getStorageError(IVector::Norm norm)                               const override;
+        ReturnCode translate(IVector const * shift, IVector::Norm norm, double accuracy) override;
+        ReturnCode scale(double factor, IVector::Norm norm, double accuracy)           override;
+        ReturnCode transform(double const * matrix, size_t outDim, IVector::Norm norm, double accuracy) override;
+        ReturnCode project(std::vector<size_t> const & axes, IVector::Norm norm, double accuracy) override;
+        ReturnCode setBloomFilter(double accuracy, size_t capacity, double falsePositiveRate) override;
+        void resetBloomFilter()                                                        override;
+        ReturnCode getBloomFilterStats(size_t & memory, double & falsePositiveRate) const override;
         ReturnCode find(IVector const * vector, IVector::Norm norm, double accuracy, size_t & ind) const override;
+        ReturnCode findBatch(double const * queries, size_t count, IVector::Norm norm, double accuracy,
+                             size_t * indices, bool * found) const override;
         ReturnCode get(IVector *& dst, size_t ind) 													const override;
         size_t getDim() 																			const override;
         size_t getSize() 																			const override;
         ISet * clone() 																				const override;
+        ReturnCode save(char const * path)                                                          const override;
+        ReturnCode getBounds(IVector *& min, IVector *& max)                                        const override;
+        ReturnCode getCentroid(IVector *& centroid)                                                 const override;
+        ReturnCode queryBox(ICompact const * compact, std::vector<size_t> & indices)                const override;
 
         ~ISetImpl()                                                                                       override;
     };
@@ -46,6 +157,326 @@ ISetImpl::ISetImpl() : _dim(0) {
     _logger = ILogger::createLogger(this);
 }
 
+// compressed coordinates are decoded into the buffer of dim doubles
+double const * ISetImpl::point(size_t ind, double * buffer) const {
+    if (_packed != nullptr) {
+        _packed->decode(ind, buffer);
+        return buffer;
+    }
+    if (_mapped_data != nullptr) {
+        return _mapped_data + ind * _dim;
+    }
+    return _data.data() + ind * _dim;
+}
+
+// coordinates must be rounded to the storage format already
+void ISetImpl::storePoint(size_t pos, double const * coords) {
+    if (_packed != nullptr) {
+        _packed->insert(pos, coords);
+    } else {
+        _data.insert(_data.begin() + pos * _dim, coords, coords + _dim);
+    }
+}
+
+double const * ISetImpl::data() const {
+    return _packed != nullptr ? nullptr : point(0, nullptr);
+}
+
+void ISetImpl::decodeAll(std::vector<double> & points) const {
+    points.resize(getSize() * _dim);
+    std::vector<double> buffer(_dim);
+    for (size_t ind = 0; ind < getSize(); ind++) {
+        double const * cur = point(ind, buffer.data());
+        std::copy(cur, cur + _dim, points.begin() + ind * _dim);
+    }
+}
+
+void ISetImpl::detach() {
+    if (_mapping == nullptr) {
+        return;
+    }
+    _data.assign(_mapped_data, _mapped_data + _mapped_size * _dim);
+    delete _mapping;
+    _mapping = nullptr;
+    _mapped_data = nullptr;
+    _mapped_size = 0;
+}
+
+void ISetImpl::updateStats() const {
+    if (_stats_valid.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_lazy_mutex);
+    if (_stats_valid.load(std::memory_order_relaxed)) {
+        return;
+    }
+    _min.assign(_dim, 0);
+    _max.assign(_dim, 0);
+    _sum.assign(_dim, 0);
+    size_t size = getSize();
+    std::vector<double> buffer(_dim);
+    if (size != 0) {
+        double const * first = point(0, buffer.data());
+        _min.assign(first, first + _dim);
+        _max.assign(first, first + _dim);
+    }
+    for (size_t ind = 0; ind < size; ind++) {
+        double const * cur = point(ind, buffer.data());
+        for (size_t i = 0; i < _dim; i++) {
+            _min[i] = std::min(_min[i], cur[i]);
+            _max[i] = std::max(_max[i], cur[i]);
+            _sum[i] += cur[i];
+        }
+    }
+    _stats_valid.store(true, std::memory_order_release);
+}
+
+// no element can be within tolerance if one coordinate alone is farther than tolerance from the bounds
+bool ISetImpl::outsideBounds(double const * coords, double accuracy) const {
+    updateStats();
+    for (size_t i = 0; i < _dim; i++) {
+        if (_min[i] - coords[i] > accuracy || coords[i] - _max[i] > accuracy) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ISetImpl::loadVector(IVector const * vector, std::vector<double> & coords) const {
+    coords.resize(vector->getDim());
+    for (size_t i = 0; i < coords.size(); i++) {
+        coords[i] = vector->getCoord(i);
+    }
+}
+
+bool ISetImpl::findPoint(double const * coords, IVector::Norm norm, double accuracy, size_t & ind) const {
+    if (getSize() == 0 || outsideBounds(coords, accuracy)) {
+        return false;
+    }
+    std::vector<double> buffer(_packed != nullptr ? _dim : 0);
+    if (accuracy == 0) {
+        buildExactIndex();
+        if (_exact_ready.load(std::memory_order_acquire)) {
+            return _exact->find(ExactIndex::hash(coords, _dim), [this, coords, &buffer](size_t id) {
+                return pointsEqual(point(id, buffer.data()), coords, _dim, IVector::Norm::NORM_INF, 0);
+            }, ind);
+        }
+    }
+    if (_bloom != nullptr && _bloom->covers(accuracy) && !_bloom->mayContain(coords, accuracy)) {
+        return false;
+    }
+    bool found;
+    if (findInCells(coords, norm, accuracy, ind, found)) {
+        return found;
+    }
+    if (_lsh != nullptr && _lsh->covers(norm, accuracy)) {
+        std::vector<size_t> candidates;
+        _lsh->candidates(coords, candidates);
+        for (auto cur_ind : candidates) {
+            if (pointsEqual(point(cur_ind, buffer.data()), coords, _dim, norm, accuracy)) {
+                ind = cur_ind;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t size = getSize();
+    for (size_t cur_ind = 0; cur_ind < size; cur_ind++) {
+        if (pointsEqual(point(cur_ind, buffer.data()), coords, _dim, norm, accuracy)) {
+            ind = cur_ind;
+            return true;
+        }
+    }
+    return false;
+}
+
+// every element within tolerance lies in a cell between the cells of coords -/+ tolerance along each axis;
+// returns false if there are too many such cells and the caller has to search otherwise
+bool ISetImpl::findInCells(double const * coords, IVector::Norm norm, double accuracy, size_t & ind, bool & found) const {
+    if (_curve == nullptr || accuracy > _cell_size) {
+        return false;
+    }
+    size_t axes = _curve->getAxes();
+    std::vector<int64_t> low(axes), high(axes);
+    size_t probes = 1;
+    for (size_t i = 0; i < axes; i++) {
+        low[i] = _curve->cell(coords[i] - accuracy);
+        high[i] = _curve->cell(coords[i] + accuracy);
+        int64_t span = high[i] - low[i] + 1;
+        if (span > (int64_t)CELL_PROBE_LIMIT || (probes *= (size_t)span) > CELL_PROBE_LIMIT) {
+            return false;
+        }
+    }
+
+    size_t size = getSize();
+    size_t best = size;
+    std::vector<int64_t> cells(low);
+    std::vector<double> buffer(_packed != nullptr ? _dim : 0);
+    while (true) {
+        auto range = std::equal_range(_keys.begin(), _keys.end(), _curve->key(cells.data()));
+        for (auto it = range.first; it != range.second && (size_t)(it - _keys.begin()) < best; ++it) {
+            if (pointsEqual(point(it - _keys.begin(), buffer.data()), coords, _dim, norm, accuracy)) {
+                best = it - _keys.begin();
+                break;
+            }
+        }
+        size_t i = 0;
+        while (i < axes && cells[i] == high[i]) {
+            cells[i] = low[i];
+            i++;
+        }
+        if (i == axes) {
+            break;
+        }
+        cells[i]++;
+    }
+    found = best != size;
+    if (found) {
+        ind = best;
+    }
+    return true;
+}
+
+void ISetImpl::insertPoint(double const * coords) {
+    if (_stats_valid) {
+        for (size_t i = 0; i < _dim; i++) {
+            _min[i] = getSize() == 0 ? coords[i] : std::min(_min[i], coords[i]);
+            _max[i] = getSize() == 0 ? coords[i] : std::max(_max[i], coords[i]);
+            _sum[i] += coords[i];
+        }
+    }
+    size_t pos = getSize();
+    if (_curve != nullptr) {
+        uint64_t key = _curve->key(coords);
+        pos = std::upper_bound(_keys.begin(), _keys.end(), key) - _keys.begin();
+        _keys.insert(_keys.begin() + pos, key);
+    }
+    storePoint(pos, coords);
+    if (_exact != nullptr) {
+        if (pos + 1 != getSize()) {
+            _exact->shiftFrom(pos);
+        }
+        _exact->insert(ExactIndex::hash(coords, _dim), pos);
+    }
+    if (_bloom != nullptr) {
+        if (getSize() > _bloom->getCapacity()) {
+            _bloom->grow(2 * _bloom->getCapacity());
+            fillBloomFilter();
+        } else {
+            _bloom->insert(coords);
+        }
+    }
+    if (_lsh != nullptr) {
+        if (pos + 1 != getSize()) {
+            _lsh->shiftFrom(pos);
+        }
+        _lsh->insert(coords, pos);
+    }
+}
+
+ReturnCode ISetImpl::buildIndex() {
+    delete _lsh;
+    _lsh = nullptr;
+    if (!_lsh_enabled || _dim == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    size_t tables = LSHIndex::tablesForRecall(_lsh_norm, _lsh_recall, _lsh_hashes);
+    _lsh = new(std::nothrow) LSHIndex(_dim, _lsh_norm, _lsh_accuracy, tables, _lsh_hashes, _lsh_seed);
+    if (_lsh == nullptr) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    std::vector<double> buffer(_dim);
+    for (size_t ind = 0; ind < getSize(); ind++) {
+        _lsh->insert(point(ind, buffer.data()), ind);
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+void ISetImpl::buildExactIndex() const {
+    if (_exact_ready.load(std::memory_order_acquire)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_lazy_mutex);
+    if (_exact != nullptr) {
+        return;
+    }
+    ExactIndex * exact = new(std::nothrow) ExactIndex(_dim);
+    if (exact == nullptr) {
+        return;
+    }
+    std::vector<double> buffer(_dim);
+    for (size_t ind = 0; ind < getSize(); ind++) {
+        exact->insert(ExactIndex::hash(point(ind, buffer.data()), _dim), ind);
+    }
+    _exact = exact;
+    _exact_ready.store(true, std::memory_order_release);
+}
+
+void ISetImpl::resetExactIndex() const {
+    delete _exact;
+    _exact = nullptr;
+    _exact_ready.store(false, std::memory_order_relaxed);
+}
+
+void ISetImpl::fillBloomFilter() {
+    updateStats();
+    _bloom->chooseAxes(_min, _max);
+    std::vector<double> buffer(_dim);
+    for (size_t ind = 0; ind < getSize(); ind++) {
+        _bloom->insert(point(ind, buffer.data()));
+    }
+}
+
+ReturnCode ISetImpl::buildCurve() {
+    delete _curve;
+    _curve = nullptr;
+    _keys.clear();
+    if (_order == StorageOrder::INSERTION || _dim == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    _curve = new(std::nothrow) CurveKey(_dim, _order, _cell_size);
+    if (_curve == nullptr) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    size_t size = getSize();
+    std::vector<double> buffer(_dim);
+    _keys.resize(size);
+    for (size_t ind = 0; ind < size; ind++) {
+        _keys[ind] = _curve->key(point(ind, buffer.data()));
+    }
+    if (std::is_sorted(_keys.begin(), _keys.end())) {
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    std::vector<size_t> perm(size);
+    std::iota(perm.begin(), perm.end(), 0);
+    std::stable_sort(perm.begin(), perm.end(), [this](size_t a, size_t b) {
+        return _keys[a] < _keys[b];
+    });
+    detach();
+    std::vector<uint64_t> keys(size);
+    for (size_t k = 0; k < size; k++) {
+        keys[k] = _keys[perm[k]];
+    }
+    _keys.swap(keys);
+    if (_packed != nullptr) {
+        _packed->reorder(perm);
+    } else {
+        std::vector<double> data(size * _dim);
+        for (size_t k = 0; k < size; k++) {
+            std::copy(_data.begin() + perm[k] * _dim, _data.begin() + (perm[k] + 1) * _dim, data.begin() + k * _dim);
+        }
+        _data.swap(data);
+    }
+    resetExactIndex();
+    return _lsh != nullptr ? buildIndex() : ReturnCode::RC_SUCCESS;
+}
+
 ReturnCode ISetImpl::insert(IVector const * vector, IVector::Norm norm, double accuracy) {
     ReturnCode r_code = validateVector(vector);
     if (r_code != ReturnCode::RC_SUCCESS) {
@@ -58,25 +489,37 @@ ReturnCode ISetImpl::insert(IVector const * vector, IVector::Norm norm, double a
         return ReturnCode::RC_INVALID_PARAMS;
     }
 
-    if (_data.empty()) {
-        _data.push_back(vector->clone());
+    std::vector<double> coords;
+    loadVector(vector, coords);
+    detach();
+
+    if (getSize() == 0) {
         _dim = vector->getDim();
-        return ReturnCode::RC_SUCCESS;
-    } else {
-        if (_dim != vector->getDim()) {
-            return ReturnCode::RC_WRONG_DIM;
+        _stats_valid = false;
+        updateStats();
+        // quantization grid starts at the first element
+        if ((r_code = buildPacked(coords.data())) != ReturnCode::RC_SUCCESS ||
+                (r_code = buildIndex()) != ReturnCode::RC_SUCCESS || (r_code = buildCurve()) != ReturnCode::RC_SUCCESS) {
+            return r_code;
         }
+    } else if (_dim != vector->getDim()) {
+        return ReturnCode::RC_WRONG_DIM;
+    }
+    if (_packed != nullptr && !_packed->round(coords.data())) {
+        LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
+        return ReturnCode::RC_OUT_OF_BOUNDS;
+    }
+    if (getSize() == 0) {
+        insertPoint(coords.data());
+        return ReturnCode::RC_SUCCESS;
     }
 
-    for (auto cur_vec : _data) {
-        bool equal = false;
-        IVector::equals(cur_vec, vector, norm, accuracy, equal, nullptr);
-        if (equal) {
-            return ReturnCode::RC_SUCCESS;
-        }
+    size_t ind;
+    if (findPoint(coords.data(), norm, accuracy, ind)) {
+        return ReturnCode::RC_SUCCESS;
     }
 
-    _data.push_back(vector->clone());
+    insertPoint(coords.data());
     return ReturnCode::RC_SUCCESS;
 }
 
@@ -93,54 +536,396 @@ ReturnCode ISetImpl::erase(IVector const * vector, IVector::Norm norm, double ac
         LOG(_logger, ReturnCode::RC_INVALID_PARAMS)
         return ReturnCode::RC_INVALID_PARAMS;
     }
-    if (_data.empty()) {
+    if (getSize() == 0) {
         LOG(_logger, ReturnCode::RC_ELEM_NOT_FOUND)
         return ReturnCode::RC_ELEM_NOT_FOUND;
     }
 
-    bool found = false;
-    for (auto cur_vec : _data) {
-        bool equal = false;
-        IVector::equals(cur_vec, vector, norm, accuracy, equal, _logger);
-        if (equal) {
-            found = true;
-            size_t cur_vec_ind;
-            find(vector, norm, accuracy, cur_vec_ind);
-            erase(cur_vec_ind);
-            break;
+    std::vector<double> coords;
+    loadVector(vector, coords);
+
+    size_t cur_vec_ind;
+    if (!findPoint(coords.data(), norm, accuracy, cur_vec_ind)) {
+        return ReturnCode::RC_ELEM_NOT_FOUND;
+    }
+    return erase(cur_vec_ind);
+}
+
+ReturnCode ISetImpl::erase(size_t index) {
+    if (index >= getSize() || index < 0) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+
+    detach();
+    std::vector<double> buffer(_dim);
+    double const * cur = point(index, buffer.data());
+    if (_stats_valid) {
+        for (size_t i = 0; i < _dim; i++) {
+            if (cur[i] == _min[i] || cur[i] == _max[i]) {
+                _stats_valid = false;
+                break;
+            }
+            _sum[i] -= cur[i];
         }
     }
-    if (!found) {
-        return ReturnCode::RC_ELEM_NOT_FOUND;
+    if (_lsh != nullptr) {
+        _lsh->erase(cur, index);
+    }
+    if (_bloom != nullptr) {
+        _bloom->erase(cur);
+    }
+    if (_exact != nullptr) {
+        _exact->erase(ExactIndex::hash(cur, _dim), index);
+    }
+    if (_curve != nullptr) {
+        _keys.erase(_keys.begin() + index);
+    }
+    if (_packed != nullptr) {
+        _packed->erase(index);
     } else {
+        _data.erase(_data.begin() + index * _dim, _data.begin() + (index + 1) * _dim);
+    }
+
+    if (getSize() == 0) {
+        _data.clear();
+        delete _packed;
+        _packed = nullptr;
+        _dim = 0;
+        delete _lsh;
+        _lsh = nullptr;
+        delete _curve;
+        _curve = nullptr;
+        resetExactIndex();
+    }
+
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISetImpl::setApproximateIndex(IVector::Norm norm, double accuracy, double recall, size_t hashes, unsigned seed) {
+    if (std::isnan(accuracy) || accuracy <= 0 || std::isnan(recall) || recall <= 0 || recall >= 1 || hashes == 0) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+
+    _lsh_enabled = true;
+    _lsh_norm = norm;
+    _lsh_accuracy = accuracy;
+    _lsh_recall = recall;
+    _lsh_hashes = hashes;
+    _lsh_seed = seed;
+    return buildIndex();
+}
+
+void ISetImpl::resetApproximateIndex() {
+    _lsh_enabled = false;
+    delete _lsh;
+    _lsh = nullptr;
+}
+
+ReturnCode ISetImpl::setStorageOrder(StorageOrder order, double cellSize) {
+    if (order != StorageOrder::INSERTION && (std::isnan(cellSize) || std::isinf(cellSize) || cellSize <= 0)) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+
+    _order = order;
+    _cell_size = cellSize;
+    return buildCurve();
+}
+
+ISet::StorageOrder ISetImpl::getStorageOrder() const {
+    return _order;
+}
+
+ReturnCode ISetImpl::buildPacked(double const * origin) {
+    delete _packed;
+    _packed = nullptr;
+    if (_format == StorageFormat::FLOAT64) {
         return ReturnCode::RC_SUCCESS;
     }
+    _packed = new(std::nothrow) PackedPoints(_dim, _format, origin, _step);
+    if (_packed == nullptr) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    return ReturnCode::RC_SUCCESS;
 }
 
-ReturnCode ISetImpl::erase(size_t index) {
-    if (index >= _data.size() || index < 0) {
+ReturnCode ISetImpl::setStorageFormat(StorageFormat format, double step) {
+    if (format == StorageFormat::QUANTIZED && (std::isnan(step) || std::isinf(step) || step <= 0)) {
         LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
         return ReturnCode::RC_INVALID_PARAMS;
     }
 
-    delete _data[index];
-    _data.erase(_data.begin() + index);
+    std::vector<double> points;
+    decodeAll(points);
+    return replacePoints(_dim, points, format, step, nullptr);
+}
+
+// new coordinates of all elements; they are rounded into the storage format first, so the set stays
+// unchanged if one does not fit, then the elements collapsing within tolerance are merged
+ReturnCode ISetImpl::replacePoints(size_t dim, std::vector<double> & points, StorageFormat format, double step,
+                                   CollapseFilter * collapse) {
+    size_t count = dim == 0 ? 0 : points.size() / dim;
+    PackedPoints * packed = nullptr;
+    if (format != StorageFormat::FLOAT64 && count != 0) {
+        std::vector<double> origin(points.begin(), points.begin() + dim);
+        for (size_t ind = 1; ind < count; ind++) {
+            for (size_t i = 0; i < dim; i++) {
+                origin[i] = std::min(origin[i], points[ind * dim + i]);
+            }
+        }
+        packed = new(std::nothrow) PackedPoints(dim, format, origin.data(), step);
+        if (packed == nullptr) {
+            LOG(_logger, ReturnCode::RC_NO_MEM);
+            return ReturnCode::RC_NO_MEM;
+        }
+        for (size_t ind = 0; ind < count; ind++) {
+            if (!packed->round(points.data() + ind * dim)) {
+                delete packed;
+                LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
+                return ReturnCode::RC_OUT_OF_BOUNDS;
+            }
+        }
+    }
+    if (collapse != nullptr) {
+        count = collapse->run(points.data(), count);
+        points.resize(count * dim);
+    }
+    if (packed != nullptr) {
+        for (size_t ind = 0; ind < count; ind++) {
+            packed->insert(ind, points.data() + ind * dim);
+        }
+    }
 
-    if (_data.empty()) {
+    detach();
+    delete _packed;
+    _packed = packed;
+    _format = format;
+    _step = step;
+    _dim = dim;
+    if (_packed == nullptr) {
+        _data.swap(points);
+    } else {
         _data.clear();
-        _dim = 0;
+        _data.shrink_to_fit();
+    }
+    // new coordinates invalidate everything computed from them
+    _stats_valid = false;
+    resetExactIndex();
+    if (_bloom != nullptr) {
+        fillBloomFilter();
+    }
+    ReturnCode r_code = buildIndex();
+    return r_code != ReturnCode::RC_SUCCESS ? r_code : buildCurve();
+}
+
+ISet::StorageFormat ISetImpl::getStorageFormat() const {
+    return _format;
+}
+
+double ISetImpl::getStorageError(IVector::Norm norm) const {
+    if (_packed == nullptr) {
+        return 0;
+    }
+    updateStats();
+    double res = 0;
+    for (size_t i = 0; i < _dim; i++) {
+        double error = _packed->error(std::max(std::fabs(_min[i]), std::fabs(_max[i])));
+        switch (norm) {
+            case IVector::Norm::NORM_1:
+                res += error;
+                break;
+            case IVector::Norm::NORM_2:
+                res += error * error;
+                break;
+            default:
+                res = std::max(res, error);
+                break;
+        }
+    }
+    return norm == IVector::Norm::NORM_2 ? std::sqrt(res) : res;
+}
+
+bool ISetImpl::checkTransform(double accuracy) const {
+    if (std::isnan(accuracy) || accuracy < 0) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return false;
+    }
+    return true;
+}
+
+// transformed coordinates replace the elements in one pass, indexes are rebuilt once afterwards
+ReturnCode ISetImpl::applyTransform(size_t dim, std::vector<double> & points, IVector::Norm norm, double accuracy) {
+    for (auto coord : points) {
+        if (std::isinf(coord) || std::isnan(coord)) {
+            LOG(_logger, ReturnCode::RC_NAN);
+            return ReturnCode::RC_NAN;
+        }
+    }
+    CollapseFilter collapse(dim, norm, accuracy);
+    return replacePoints(dim, points, _format, _step, &collapse);
+}
+
+ReturnCode ISetImpl::translate(IVector const * shift, IVector::Norm norm, double accuracy) {
+    ReturnCode r_code = validateVector(shift);
+    if (r_code != ReturnCode::RC_SUCCESS) {
+        LOG(_logger, r_code);
+        return r_code;
+    }
+    if (!checkTransform(accuracy)) {
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    size_t size = getSize();
+    if (size == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+    if (shift->getDim() != _dim) {
+        LOG(_logger, ReturnCode::RC_WRONG_DIM);
+        return ReturnCode::RC_WRONG_DIM;
+    }
+
+    std::vector<double> offset;
+    loadVector(shift, offset);
+    std::vector<double> points;
+    decodeAll(points);
+    for (size_t ind = 0; ind < size; ind++) {
+        double * cur = points.data() + ind * _dim;
+        for (size_t i = 0; i < _dim; i++) {
+            cur[i] += offset[i];
+        }
+    }
+    return applyTransform(_dim, points, norm, accuracy);
+}
+
+ReturnCode ISetImpl::scale(double factor, IVector::Norm norm, double accuracy) {
+    if (std::isinf(factor) || std::isnan(factor)) {
+        LOG(_logger, ReturnCode::RC_NAN);
+        return ReturnCode::RC_NAN;
+    }
+    if (!checkTransform(accuracy)) {
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    if (getSize() == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    std::vector<double> points;
+    decodeAll(points);
+    for (auto & coord : points) {
+        coord *= factor;
+    }
+    return applyTransform(_dim, points, norm, accuracy);
+}
+
+ReturnCode ISetImpl::transform(double const * matrix, size_t outDim, IVector::Norm norm, double accuracy) {
+    if (matrix == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    if (outDim == 0) {
+        LOG(_logger, ReturnCode::RC_ZERO_DIM);
+        return ReturnCode::RC_ZERO_DIM;
+    }
+    if (!checkTransform(accuracy)) {
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    size_t size = getSize();
+    if (size == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    std::vector<double> points;
+    decodeAll(points);
+    std::vector<double> result(size * outDim);
+    for (size_t ind = 0; ind < size; ind++) {
+        double const * cur = points.data() + ind * _dim;
+        for (size_t r = 0; r < outDim; r++) {
+            double const * row = matrix + r * _dim;
+            double sum = 0;
+            for (size_t i = 0; i < _dim; i++) {
+                sum += row[i] * cur[i];
+            }
+            result[ind * outDim + r] = sum;
+        }
+    }
+    return applyTransform(outDim, result, norm, accuracy);
+}
+
+ReturnCode ISetImpl::project(std::vector<size_t> const & axes, IVector::Norm norm, double accuracy) {
+    if (axes.empty()) {
+        LOG(_logger, ReturnCode::RC_ZERO_DIM);
+        return ReturnCode::RC_ZERO_DIM;
+    }
+    if (!checkTransform(accuracy)) {
+        return ReturnCode::RC_INVALID_PARAMS;
     }
+    size_t size = getSize();
+    if (size == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+    for (auto axis : axes) {
+        if (axis >= _dim) {
+            LOG(_logger, ReturnCode::RC_OUT_OF_BOUNDS);
+            return ReturnCode::RC_OUT_OF_BOUNDS;
+        }
+    }
+
+    std::vector<double> points;
+    decodeAll(points);
+    size_t dim = axes.size();
+    std::vector<double> result(size * dim);
+    for (size_t ind = 0; ind < size; ind++) {
+        for (size_t k = 0; k < dim; k++) {
+            result[ind * dim + k] = points[ind * _dim + axes[k]];
+        }
+    }
+    return applyTransform(dim, result, norm, accuracy);
+}
+
+ReturnCode ISetImpl::setBloomFilter(double accuracy, size_t capacity, double falsePositiveRate) {
+    if (std::isnan(accuracy) || std::isinf(accuracy) || accuracy <= 0 || capacity == 0 ||
+            std::isnan(falsePositiveRate) || falsePositiveRate <= 0 || falsePositiveRate >= 1) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+
+    delete _bloom;
+    _bloom = new(std::nothrow) BloomFilter(accuracy, std::max(capacity, getSize()), falsePositiveRate);
+    if (_bloom == nullptr) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    fillBloomFilter();
+    return ReturnCode::RC_SUCCESS;
+}
 
+void ISetImpl::resetBloomFilter() {
+    delete _bloom;
+    _bloom = nullptr;
+}
+
+ReturnCode ISetImpl::getBloomFilterStats(size_t & memory, double & falsePositiveRate) const {
+    if (_bloom == nullptr) {
+        return ReturnCode::RC_INIT_REQUIRED;
+    }
+    memory = _bloom->getMemory();
+    falsePositiveRate = _bloom->falsePositiveRate(getSize());
     return ReturnCode::RC_SUCCESS;
 }
 
 ReturnCode ISetImpl::get(IVector*& dst, size_t ind) const {
-    if (ind >= _data.size()) {
+    if (ind >= getSize()) {
         LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
         return ReturnCode::RC_INVALID_PARAMS;
     }
 
-    dst = _data[ind]->clone();
+    std::vector<double> buffer(_dim);
+    dst = IVector::createVector(_dim, const_cast<double *>(point(ind, buffer.data())), _logger);
+    if (dst == nullptr) {
+        return ReturnCode::RC_NO_MEM;
+    }
     return ReturnCode::RC_SUCCESS;
 }
 
@@ -159,31 +944,104 @@ ReturnCode ISetImpl::find(IVector const* vector, IVector::Norm norm, double accu
         return ReturnCode::RC_INVALID_PARAMS;
     }
 
-    if (_data.size() == 0 || _dim == 0) {
+    if (getSize() == 0 || _dim == 0) {
         return ReturnCode::RC_ELEM_NOT_FOUND;
     }
 
-    size_t capacity = _data.size();
-    IVector * cur_vec;
+    std::vector<double> coords;
+    loadVector(vector, coords);
 
-    for (size_t cur_vec_ind = 0; cur_vec_ind < capacity; cur_vec_ind++) {
-        cur_vec = _data[cur_vec_ind];
-        bool equal = false;
-        IVector::equals(cur_vec, vector, norm, accuracy, equal, nullptr);
-        if (equal) {
-            ind = cur_vec_ind;
-            return ReturnCode::RC_SUCCESS;
-        }
+    if (findPoint(coords.data(), norm, accuracy, ind)) {
+        return ReturnCode::RC_SUCCESS;
     }
     return ReturnCode::RC_ELEM_NOT_FOUND;
 }
 
+ReturnCode ISetImpl::findBatch(double const * queries, size_t count, IVector::Norm norm, double accuracy,
+                               size_t * indices, bool * found) const {
+    if (count == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+    if (queries == nullptr || indices == nullptr || found == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    if (std::isnan(accuracy) || accuracy < 0) {
+        LOG(_logger, ReturnCode::RC_INVALID_PARAMS);
+        return ReturnCode::RC_INVALID_PARAMS;
+    }
+    std::fill(found, found + count, false);
+    size_t size = getSize();
+    if (size == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    // few queries or hash, LSH and cell lookups are cheaper one by one than sorting the whole set
+    if (count < BATCH_SORT_MIN || accuracy == 0 || (_lsh != nullptr && _lsh->covers(norm, accuracy)) ||
+            (_curve != nullptr && accuracy <= _cell_size)) {
+        for (size_t q = 0; q < count; q++) {
+            found[q] = findPoint(queries + q * _dim, norm, accuracy, indices[q]);
+        }
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    // elements and queries are sorted along the widest axis, so every query checks only
+    // the elements closer than tolerance along it and consecutive queries reuse cached elements
+    updateStats();
+    size_t axis = 0;
+    for (size_t i = 1; i < _dim; i++) {
+        if (_max[i] - _min[i] > _max[axis] - _min[axis]) {
+            axis = i;
+        }
+    }
+    std::vector<std::pair<double, size_t>> elems(size);
+    std::vector<double> buffer(_dim);
+    for (size_t ind = 0; ind < size; ind++) {
+        elems[ind] = std::make_pair(point(ind, buffer.data())[axis], ind);
+    }
+    std::sort(elems.begin(), elems.end());
+    std::vector<std::pair<double, size_t>> order(count);
+    for (size_t q = 0; q < count; q++) {
+        order[q] = std::make_pair(queries[q * _dim + axis], q);
+    }
+    std::sort(order.begin(), order.end());
+
+    size_t low = 0;
+    for (auto const & query : order) {
+        double const * coords = queries + query.second * _dim;
+        if (outsideBounds(coords, accuracy)) {
+            continue;
+        }
+        while (low < size && beyondTolerance(query.first - elems[low].first, accuracy)) {
+            low++;
+        }
+        // the first matching element in storage order is reported, as find does
+        size_t best = size;
+        for (size_t k = low; k < size && !beyondTolerance(elems[k].first - query.first, accuracy); k++) {
+            if (elems[k].second < best && pointsEqual(point(elems[k].second, buffer.data()), coords, _dim, norm, accuracy)) {
+                best = elems[k].second;
+            }
+        }
+        if (best != size) {
+            indices[query.second] = best;
+            found[query.second] = true;
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
 size_t ISetImpl::getDim() const {
     return _dim;
 }
 
 size_t ISetImpl::getSize() const {
-    return _data.size();
+    if (_packed != nullptr) {
+        return _packed->size();
+    }
+    if (_mapped_data != nullptr) {
+        return _mapped_size;
+    }
+    return _dim == 0 ? 0 : _data.size() / _dim;
 }
 
 ISet* ISetImpl::clone() const {
@@ -194,29 +1052,467 @@ ISet* ISetImpl::clone() const {
     }
 
     new_set->_dim = _dim;
-    for (auto cur_vec : _data) {
-        new_set->_data.push_back(cur_vec->clone());
+    new_set->_format = _format;
+    new_set->_step = _step;
+    if (_packed != nullptr) {
+        new_set->_packed = new(std::nothrow) PackedPoints(*_packed);
+        if (new_set->_packed == nullptr) {
+            LOG(_logger, ReturnCode::RC_NO_MEM)
+            delete new_set;
+            return nullptr;
+        }
+    } else {
+        new_set->_data.assign(point(0, nullptr), point(getSize(), nullptr));
+    }
+
+    new_set->_lsh_enabled = _lsh_enabled;
+    new_set->_lsh_norm = _lsh_norm;
+    new_set->_lsh_accuracy = _lsh_accuracy;
+    new_set->_lsh_recall = _lsh_recall;
+    new_set->_lsh_hashes = _lsh_hashes;
+    new_set->_lsh_seed = _lsh_seed;
+    if (_lsh != nullptr) {
+        new_set->_lsh = new(std::nothrow) LSHIndex(*_lsh);
+        if (new_set->_lsh == nullptr) {
+            LOG(_logger, ReturnCode::RC_NO_MEM)
+            delete new_set;
+            return nullptr;
+        }
+    }
+
+    if (_bloom != nullptr) {
+        new_set->_bloom = new(std::nothrow) BloomFilter(*_bloom);
+        if (new_set->_bloom == nullptr) {
+            LOG(_logger, ReturnCode::RC_NO_MEM)
+            delete new_set;
+            return nullptr;
+        }
+    }
+
+    new_set->_order = _order;
+    new_set->_cell_size = _cell_size;
+    new_set->_keys = _keys;
+    if (_curve != nullptr) {
+        new_set->_curve = new(std::nothrow) CurveKey(*_curve);
+        if (new_set->_curve == nullptr) {
+            LOG(_logger, ReturnCode::RC_NO_MEM)
+            delete new_set;
+            return nullptr;
+        }
     }
 
     return new_set;
 }
 
 void ISetImpl::clear() {
-    for(auto cur_vec : _data) {
-        delete cur_vec;
-    }
+    detach();
+    _stats_valid = false;
     _data.clear();
+    delete _packed;
+    _packed = nullptr;
     _dim = 0;
+    delete _lsh;
+    _lsh = nullptr;
+    delete _curve;
+    _curve = nullptr;
+    _keys.clear();
+    if (_bloom != nullptr) {
+        _bloom->clear();
+    }
+    resetExactIndex();
 }
 
 ISetImpl::~ISetImpl() {
-    for(auto cur_vec : _data) {
-        delete cur_vec;
-    }
+    delete _mapping;
+    _mapping = nullptr;
     _data.clear();
+    delete _packed;
+    _packed = nullptr;
     _dim = 0;
+    delete _lsh;
+    _lsh = nullptr;
+    delete _curve;
+    _curve = nullptr;
+    delete _bloom;
+    _bloom = nullptr;
+    resetExactIndex();
 
     if (_logger != nullptr) {
         _logger->releaseLogger(this);
     }
-}
\ No newline at end of file
+}
+
+ReturnCode ISetImpl::getBounds(IVector *& min, IVector *& max) const {
+    if (getSize() == 0) {
+        LOG(_logger, ReturnCode::RC_ZERO_DIM);
+        return ReturnCode::RC_ZERO_DIM;
+    }
+    updateStats();
+    min = IVector::createVector(_dim, _min.data(), _logger);
+    max = IVector::createVector(_dim, _max.data(), _logger);
+    if (min == nullptr || max == nullptr) {
+        delete min;
+        delete max;
+        min = max = nullptr;
+        return ReturnCode::RC_NO_MEM;
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISetImpl::getCentroid(IVector *& centroid) const {
+    if (getSize() == 0) {
+        LOG(_logger, ReturnCode::RC_ZERO_DIM);
+        return ReturnCode::RC_ZERO_DIM;
+    }
+    updateStats();
+    std::vector<double> mean(_sum);
+    for (auto & coord : mean) {
+        coord /= getSize();
+    }
+    centroid = IVector::createVector(_dim, mean.data(), _logger);
+    if (centroid == nullptr) {
+        return ReturnCode::RC_NO_MEM;
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISetImpl::queryBox(ICompact const * compact, std::vector<size_t> & indices) const {
+    indices.clear();
+    if (compact == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+    size_t size = getSize();
+    if (size == 0) {
+        return ReturnCode::RC_SUCCESS;
+    }
+    if (compact->getDim() != _dim) {
+        LOG(_logger, ReturnCode::RC_WRONG_DIM);
+        return ReturnCode::RC_WRONG_DIM;
+    }
+
+    IVector * begin = compact->getBegin();
+    IVector * end = compact->getEnd();
+    if (begin == nullptr || end == nullptr) {
+        delete begin;
+        delete end;
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return ReturnCode::RC_NO_MEM;
+    }
+    std::vector<double> low, high;
+    loadVector(begin, low);
+    loadVector(end, high);
+    delete begin;
+    delete end;
+
+    updateStats();
+    bool covers_all = true;
+    for (size_t i = 0; i < _dim; i++) {
+        if (high[i] < _min[i] || low[i] > _max[i]) {
+            return ReturnCode::RC_SUCCESS;
+        }
+        covers_all = covers_all && low[i] <= _min[i] && high[i] >= _max[i];
+    }
+    if (covers_all) {
+        indices.resize(size);
+        for (size_t ind = 0; ind < size; ind++) {
+            indices[ind] = ind;
+        }
+        return ReturnCode::RC_SUCCESS;
+    }
+
+    std::vector<double> buffer(_dim);
+    for (size_t ind = 0; ind < size; ind++) {
+        double const * cur = point(ind, buffer.data());
+        // branchless test of all axes lets the loop be vectorized
+        bool inside = true;
+        for (size_t i = 0; i < _dim; i++) {
+            inside &= (cur[i] >= low[i]) & (cur[i] <= high[i]);
+        }
+        if (inside) {
+            indices.push_back(ind);
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISetImpl::save(char const * path) const {
+    if (path == nullptr) {
+        LOG(_logger, ReturnCode::RC_NULL_PTR);
+        return ReturnCode::RC_NULL_PTR;
+    }
+
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.dim = _dim;
+    header.count = getSize();
+    header.norm = (uint32_t)_lsh_norm;
+    header.tolerance = _lsh_accuracy;
+    header.recall = _lsh_recall;
+    header.hashes = _lsh_hashes;
+    header.seed = _lsh_seed;
+    header.index_offset = sizeof(header) + header.count * header.dim * sizeof(double);
+    header.order = (uint32_t)_order;
+    header.cell_size = _cell_size;
+    if (_lsh != nullptr) {
+        header.flags |= SNAPSHOT_LSH;
+        header.tables = _lsh->getTables();
+    }
+
+    FILE * file = fopen(path, "wb");
+    if (file == nullptr) {
+        LOG(_logger, ReturnCode::RC_OPEN_FILE);
+        return ReturnCode::RC_OPEN_FILE;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    size_t coords = getSize() * _dim;
+    if (written && coords != 0) {
+        // compressed storage is saved decoded
+        std::vector<double> decoded;
+        double const * points = data();
+        if (points == nullptr) {
+            decodeAll(decoded);
+            points = decoded.data();
+        }
+        written = fwrite(points, sizeof(double), coords, file) == coords;
+    }
+    if (written && _lsh != nullptr) {
+        std::vector<double> const & shifts = _lsh->getShifts();
+        if (_lsh_norm == IVector::Norm::NORM_INF) {
+            std::vector<uint64_t> axes(_lsh->getAxes().begin(), _lsh->getAxes().end());
+            written = fwrite(axes.data(), sizeof(uint64_t), axes.size(), file) == axes.size();
+        } else {
+            std::vector<double> const & proj = _lsh->getProjections();
+            written = fwrite(proj.data(), sizeof(double), proj.size(), file) == proj.size();
+        }
+        written = written && fwrite(shifts.data(), sizeof(double), shifts.size(), file) == shifts.size();
+
+        std::vector<uint64_t> keys;
+        _lsh->exportKeys(keys, getSize());
+        written = written && fwrite(keys.data(), sizeof(uint64_t), keys.size(), file) == keys.size();
+    }
+    if (fclose(file) != 0 || !written) {
+        LOG(_logger, ReturnCode::RC_OPEN_FILE);
+        return ReturnCode::RC_OPEN_FILE;
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode ISetImpl::loadIndex(SnapshotHeader const & header, char const * base) {
+    IVector::Norm norm = (IVector::Norm)header.norm;
+    size_t funcs = header.tables * header.hashes;
+    char const * cur = base + header.index_offset;
+    double const * proj = nullptr;
+    uint64_t const * axes = nullptr;
+    if (norm == IVector::Norm::NORM_INF) {
+        axes = (uint64_t const *)cur;
+        cur += funcs * sizeof(uint64_t);
+        // axes are read from the file, a corrupted one would index past the point
+        for (size_t h = 0; h < funcs; h++) {
+            if (axes[h] >= header.dim) {
+                return ReturnCode::RC_INVALID_PARAMS;
+            }
+        }
+    } else {
+        proj = (double const *)cur;
+        cur += funcs * _dim * sizeof(double);
+    }
+
+    _lsh_enabled = true;
+    _lsh_norm = norm;
+    _lsh_accuracy = header.tolerance;
+    _lsh_recall = header.recall;
+    _lsh_hashes = header.hashes;
+    _lsh_seed = (unsigned)header.seed;
+    double const * shifts = (double const *)cur;
+    cur += funcs * sizeof(double);
+    uint64_t const * keys = (uint64_t const *)cur;
+
+    _lsh = new(std::nothrow) LSHIndex(_dim, _lsh_norm, _lsh_accuracy, header.tables, header.hashes, proj, axes, shifts);
+    if (_lsh == nullptr) {
+        return ReturnCode::RC_NO_MEM;
+    }
+    for (size_t ind = 0; ind < header.count; ind++) {
+        for (size_t t = 0; t < header.tables; t++) {
+            _lsh->insertKey(t, keys[ind * header.tables + t], ind);
+        }
+    }
+    return ReturnCode::RC_SUCCESS;
+}
+
+ISet * ISetImpl::openMapped(char const * path, ILogger * logger) {
+    if (path == nullptr) {
+        LOG(logger, ReturnCode::RC_NULL_PTR);
+        return nullptr;
+    }
+
+    MappedFile * mapping = new(std::nothrow) MappedFile();
+    if (mapping == nullptr) {
+        LOG(logger, ReturnCode::RC_NO_MEM);
+        return nullptr;
+    }
+    if (!mapping->open(path)) {
+        LOG(logger, ReturnCode::RC_OPEN_FILE);
+        delete mapping;
+        return nullptr;
+    }
+    char const * base = (char const *)mapping->data();
+    SnapshotHeader header;
+    if (mapping->size() >= sizeof(header)) {
+        std::memcpy(&header, base, sizeof(header));
+    }
+    if (mapping->size() < sizeof(header) || !checkSnapshotHeader(header, mapping->size())) {
+        LOG(logger, ReturnCode::RC_INVALID_PARAMS);
+        delete mapping;
+        return nullptr;
+    }
+
+    ISetImpl * set = new(std::nothrow) ISetImpl();
+    if (set == nullptr) {
+        LOG(logger, ReturnCode::RC_NO_MEM);
+        delete mapping;
+        return nullptr;
+    }
+    set->_dim = header.dim;
+    set->_mapping = mapping;
+    set->_mapped_data = (double const *)(base + sizeof(header));
+    set->_mapped_size = header.count;
+    if (header.count == 0) {
+        set->detach();
+    }
+
+    if ((header.flags & SNAPSHOT_LSH) && header.count != 0) {
+        ReturnCode r_code = set->loadIndex(header, base);
+        if (r_code != ReturnCode::RC_SUCCESS) {
+            LOG(logger, r_code);
+            delete set;
+            return nullptr;
+        }
+    }
+    set->_order = (StorageOrder)header.order;
+    set->_cell_size = header.cell_size;
+    if (set->buildCurve() != ReturnCode::RC_SUCCESS) {
+        LOG(logger, ReturnCode::RC_NO_MEM);
+        delete set;
+        return nullptr;
+    }
+    return set;
+}
+
+bool ISetImpl::sameOrder(ISet const * set1, ISet const * set2, double accuracy) {
+    ISetImpl const * ordered1 = dynamic_cast<ISetImpl const *>(set1);
+    ISetImpl const * ordered2 = dynamic_cast<ISetImpl const *>(set2);
+    return ordered1 != nullptr && ordered2 != nullptr && ordered1->_curve != nullptr && ordered2->_curve != nullptr &&
+            ordered1->_dim == ordered2->_dim && ordered1->_order == ordered2->_order &&
+            ordered1->_cell_size == ordered2->_cell_size && accuracy <= ordered1->_cell_size &&
+            (ordered1->_packed == nullptr) == (ordered2->_packed == nullptr) &&
+            (ordered1->_packed == nullptr || ordered1->_packed->sameCodec(*ordered2->_packed));
+}
+
+// empty set with the same dimension, storage format, storage order and index settings
+ISetImpl * ISetImpl::createLike() const {
+    ISetImpl * set = new(std::nothrow) ISetImpl();
+    if (set == nullptr) {
+        LOG(_logger, ReturnCode::RC_NO_MEM);
+        return nullptr;
+    }
+    set->_dim = _dim;
+    set->_format = _format;
+    set->_step = _step;
+    if (_packed != nullptr) {
+        set->_packed = new(std::nothrow) PackedPoints(_packed->emptyCopy());
+        if (set->_packed == nullptr) {
+            delete set;
+            return nullptr;
+        }
+    }
+    set->_order = _order;
+    set->_cell_size = _cell_size;
+    set->_lsh_enabled = _lsh_enabled;
+    set->_lsh_norm = _lsh_norm;
+    set->_lsh_accuracy = _lsh_accuracy;
+    set->_lsh_recall = _lsh_recall;
+    set->_lsh_hashes = _lsh_hashes;
+    set->_lsh_seed = _lsh_seed;
+    if (set->buildCurve() != ReturnCode::RC_SUCCESS) {
+        delete set;
+        return nullptr;
+    }
+    return set;
+}
+
+// elements of this set which are (or are not) within tolerance of other, skipping ones within tolerance
+// of exclude or of already selected; elements come in key order, so they are appended at the end
+ISetImpl * ISetImpl::selectOrdered(ISetImpl const * other, bool within, ISetImpl const * exclude,
+                                   IVector::Norm norm, double accuracy) const {
+    ISetImpl * result = createLike();
+    if (result == nullptr) {
+        return nullptr;
+    }
+    result->_lsh_enabled = false;
+    size_t ind;
+    std::vector<double> buffer(_dim);
+    for (size_t cur = 0; cur < getSize(); cur++) {
+        double const * coords = point(cur, buffer.data());
+        if (other->findPoint(coords, norm, accuracy, ind) == within &&
+                (exclude == nullptr || !exclude->findPoint(coords, norm, accuracy, ind)) &&
+                !result->findPoint(coords, norm, accuracy, ind)) {
+            result->insertPoint(coords);
+        }
+    }
+    return result;
+}
+
+// merge of two key-sorted storages, elements of this set go first among equal keys
+ISetImpl * ISetImpl::mergeOrdered(ISetImpl const * other) const {
+    ISetImpl * result = createLike();
+    if (result == nullptr) {
+        return nullptr;
+    }
+    size_t size1 = getSize(), size2 = other->getSize();
+    if (result->_packed == nullptr) {
+        result->_data.reserve((size1 + size2) * _dim);
+    }
+    result->_keys.reserve(size1 + size2);
+    std::vector<double> buffer(_dim);
+    size_t i = 0, j = 0;
+    while (i < size1 || j < size2) {
+        bool first = j == size2 || (i < size1 && _keys[i] <= other->_keys[j]);
+        double const * cur = first ? point(i, buffer.data()) : other->point(j, buffer.data());
+        result->storePoint(result->getSize(), cur);
+        result->_keys.push_back(first ? _keys[i++] : other->_keys[j++]);
+    }
+    if (result->getSize() == 0) {
+        result->clear();
+    }
+    if (result->buildIndex() != ReturnCode::RC_SUCCESS) {
+        delete result;
+        return nullptr;
+    }
+    return result;
+}
+
+ISet * ISetImpl::unionOrdered(ISet const * set1, ISet const * set2, IVector::Norm norm, double accuracy) {
+    ISetImpl const * ordered1 = static_cast<ISetImpl const *>(set1);
+    ISetImpl const * ordered2 = static_cast<ISetImpl const *>(set2);
+    ISetImpl * extra = ordered2->selectOrdered(ordered1, false, nullptr, norm, accuracy);
+    if (extra == nullptr) {
+        return nullptr;
+    }
+    ISetImpl * result = ordered1->mergeOrdered(extra);
+    delete extra;
+    return result;
+}
+
+ISet * ISetImpl::intersectionOrdered(ISet const * set1, ISet const * set2, IVector::Norm norm, double accuracy) {
+    ISetImpl const * ordered1 = static_cast<ISetImpl const *>(set1);
+    ISetImpl const * ordered2 = static_cast<ISetImpl const *>(set2);
+    ISetImpl * left = ordered1->selectOrdered(ordered2, true, nullptr, norm, accuracy);
+    ISetImpl * right = left == nullptr ? nullptr : ordered2->selectOrdered(ordered1, true, left, norm, accuracy);
+    ISetImpl * result = right == nullptr ? nullptr : left->mergeOrdered(right);
+    delete left;
+    delete right;
+    return result;
+}
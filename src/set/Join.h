@@ -0,0 +1,161 @@
+#ifndef JOIN_H
+#define JOIN_H
+
+#include "include/ISet.h"
+#include "Distance.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace {
+    // all pairs of points closer than tolerance: a sweep along the widest axis for low dimensions,
+    // where one axis prunes well, and cache-sized tiles of points compared block by block otherwise
+    class ToleranceJoin {
+    public:
+        static size_t const SWEEP_MAX_DIM = 8;
+        static size_t const TILE_BYTES = 16384;
+        static size_t const PUSH_BATCH = 1024;
+
+        ToleranceJoin(size_t dim, IVector::Norm norm, double accuracy, ISet::PushPairs push, void * push_context) :
+                _dim(dim),
+                _norm(norm),
+                _accuracy(accuracy),
+                _push(push),
+                _push_context(push_context) {
+        }
+
+        // pairs (i, j) with i < j inside one batch of points
+        ReturnCode selfJoin(double const * points, size_t count) {
+            return join(points, count, points, count, true);
+        }
+
+        // pairs (i, j) with i from the first batch and j from the second one
+        ReturnCode join(double const * points1, size_t count1, double const * points2, size_t count2) {
+            return join(points1, count1, points2, count2, false);
+        }
+
+        size_t getPairCount() const {
+            return _pair_count;
+        }
+
+    private:
+        ReturnCode join(double const * points1, size_t count1, double const * points2, size_t count2, bool self) {
+            _pair_count = 0;
+            _pairs.clear();
+            if (count1 == 0 || count2 == 0) {
+                return ReturnCode::RC_SUCCESS;
+            }
+            ReturnCode r_code = _dim <= SWEEP_MAX_DIM ? sweep(points1, count1, points2, count2, self)
+                                                      : tiles(points1, count1, points2, count2, self);
+            return r_code != ReturnCode::RC_SUCCESS ? r_code : flush();
+        }
+
+        size_t widestAxis(double const * points, size_t count) const {
+            size_t axis = 0;
+            double best = -1;
+            for (size_t j = 0; j < _dim; j++) {
+                double min = points[j], max = points[j];
+                for (size_t i = 1; i < count; i++) {
+                    min = std::min(min, points[i * _dim + j]);
+                    max = std::max(max, points[i * _dim + j]);
+                }
+                if (max - min > best) {
+                    best = max - min;
+                    axis = j;
+                }
+            }
+            return axis;
+        }
+
+        void sortAlong(double const * points, size_t count, size_t axis, std::vector<std::pair<double, size_t>> & order) const {
+            order.resize(count);
+            for (size_t i = 0; i < count; i++) {
+                order[i] = std::make_pair(points[i * _dim + axis], i);
+            }
+            std::sort(order.begin(), order.end());
+        }
+
+        // any norm of the difference is not less than its coordinate along the sweep axis
+        ReturnCode sweep(double const * points1, size_t count1, double const * points2, size_t count2, bool self) {
+            size_t axis = widestAxis(points1, count1);
+            std::vector<std::pair<double, size_t>> order1, order2;
+            sortAlong(points1, count1, axis, order1);
+            if (!self) {
+                sortAlong(points2, count2, axis, order2);
+            }
+            std::vector<std::pair<double, size_t>> const & other = self ? order1 : order2;
+
+            size_t low = 0;
+            for (size_t k = 0; k < count1; k++) {
+                double const * cur = points1 + order1[k].second * _dim;
+                size_t start = k + 1;
+                if (!self) {
+                    while (low < count2 && beyondTolerance(order1[k].first - other[low].first, _accuracy)) {
+                        low++;
+                    }
+                    start = low;
+                }
+                for (size_t m = start; m < count2 && !beyondTolerance(other[m].first - order1[k].first, _accuracy); m++) {
+                    if (pointsEqual(cur, points2 + other[m].second * _dim, _dim, _norm, _accuracy)) {
+                        size_t i = order1[k].second, j = other[m].second;
+                        ReturnCode r_code = self && j < i ? add(j, i) : add(i, j);
+                        if (r_code != ReturnCode::RC_SUCCESS) {
+                            return r_code;
+                        }
+                    }
+                }
+            }
+            return ReturnCode::RC_SUCCESS;
+        }
+
+        // tiles of both batches fit the L1 cache together, so every loaded point is compared with a whole tile
+        ReturnCode tiles(double const * points1, size_t count1, double const * points2, size_t count2, bool self) {
+            size_t tile = std::max<size_t>(1, TILE_BYTES / (2 * _dim * sizeof(double)));
+            for (size_t begin1 = 0; begin1 < count1; begin1 += tile) {
+                size_t end1 = std::min(count1, begin1 + tile);
+                for (size_t begin2 = self ? begin1 : 0; begin2 < count2; begin2 += tile) {
+                    size_t end2 = std::min(count2, begin2 + tile);
+                    for (size_t i = begin1; i < end1; i++) {
+                        double const * cur = points1 + i * _dim;
+                        for (size_t j = self ? std::max(begin2, i + 1) : begin2; j < end2; j++) {
+                            if (pointsEqual(cur, points2 + j * _dim, _dim, _norm, _accuracy)) {
+                                ReturnCode r_code = add(i, j);
+                                if (r_code != ReturnCode::RC_SUCCESS) {
+                                    return r_code;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            return ReturnCode::RC_SUCCESS;
+        }
+
+        ReturnCode add(size_t i, size_t j) {
+            _pairs.push_back(i);
+            _pairs.push_back(j);
+            return _pairs.size() >= 2 * PUSH_BATCH ? flush() : ReturnCode::RC_SUCCESS;
+        }
+
+        ReturnCode flush() {
+            size_t count = _pairs.size() / 2;
+            if (count == 0) {
+                return ReturnCode::RC_SUCCESS;
+            }
+            _pair_count += count;
+            ReturnCode r_code = _push(_push_context, _pairs.data(), count);
+            _pairs.clear();
+            return r_code;
+        }
+
+        size_t _dim;
+        IVector::Norm _norm;
+        double _accuracy;
+        ISet::PushPairs _push;
+        void * _push_context;
+        std::vector<size_t> _pairs;
+        size_t _pair_count {0};
+    };
+}
+
+#endif /* JOIN_H */
@@ -0,0 +1,248 @@
+#ifndef LSH_INDEX_H
+#define LSH_INDEX_H
+
+#include "include/IVector.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    // locality-sensitive hashing over points of one set:
+    // p-stable projections (Cauchy for NORM_1, Gaussian for NORM_2) and coordinate sampling for NORM_INF
+    class LSHIndex {
+    public:
+        // bucket width in units of the indexed tolerance
+        static constexpr double WIDTH_SCALE = 4.0;
+        static constexpr size_t MAX_TABLES  = 512;
+
+        // probability that two points at distance equal to the tolerance share one hash value
+        static double collisionProbability(IVector::Norm norm) {
+            double const pi = 3.14159265358979323846;
+            double const u = WIDTH_SCALE;
+            switch (norm) {
+                case IVector::Norm::NORM_1:
+                    return 2.0 / pi * std::atan(u) - std::log(1.0 + u * u) / (pi * u);
+                case IVector::Norm::NORM_2:
+                    return 1.0 - std::erfc(u / std::sqrt(2.0)) - 2.0 / (std::sqrt(2.0 * pi) * u) * (1.0 - std::exp(-u * u / 2.0));
+                case IVector::Norm::NORM_INF:
+                    return 1.0 - 1.0 / u;
+            }
+            return 0;
+        }
+
+        // number of tables giving at least the requested recall for points closer than the tolerance
+        static size_t tablesForRecall(IVector::Norm norm, double recall, size_t hashes) {
+            double p_table = std::pow(collisionProbability(norm), (double)hashes);
+            double tables = std::ceil(std::log(1.0 - recall) / std::log(1.0 - p_table));
+            if (tables < 1) {
+                return 1;
+            }
+            if (tables > MAX_TABLES) {
+                return MAX_TABLES;
+            }
+            return (size_t)tables;
+        }
+
+        LSHIndex(size_t dim, IVector::Norm norm, double accuracy, size_t tables, size_t hashes, unsigned seed) :
+                _dim(dim),
+                _norm(norm),
+                _accuracy(accuracy),
+                _width(WIDTH_SCALE * accuracy),
+                _tables(tables),
+                _hashes(hashes),
+                _buckets(tables) {
+            std::mt19937 gen(seed);
+            std::uniform_real_distribution<double> shift(0.0, _width);
+            size_t funcs = _tables * _hashes;
+            _shifts.resize(funcs);
+            if (_norm == IVector::Norm::NORM_INF) {
+                std::uniform_int_distribution<size_t> axis(0, _dim - 1);
+                _axes.resize(funcs);
+                for (size_t i = 0; i < funcs; i++) {
+                    _axes[i] = axis(gen);
+                    _shifts[i] = shift(gen);
+                }
+                return;
+            }
+            _proj.resize(funcs * _dim);
+            std::normal_distribution<double> gauss(0.0, 1.0);
+            std::cauchy_distribution<double> cauchy(0.0, 1.0);
+            for (size_t i = 0; i < funcs; i++) {
+                for (size_t j = 0; j < _dim; j++) {
+                    _proj[i * _dim + j] = _norm == IVector::Norm::NORM_2 ? gauss(gen) : cauchy(gen);
+                }
+                _shifts[i] = shift(gen);
+            }
+        }
+
+        // index with hash functions restored from a snapshot, buckets are filled by insertKey
+        LSHIndex(size_t dim, IVector::Norm norm, double accuracy, size_t tables, size_t hashes,
+                 double const * proj, uint64_t const * axes, double const * shifts) :
+                _dim(dim),
+                _norm(norm),
+                _accuracy(accuracy),
+                _width(WIDTH_SCALE * accuracy),
+                _tables(tables),
+                _hashes(hashes),
+                _shifts(shifts, shifts + tables * hashes),
+                _buckets(tables) {
+            size_t funcs = _tables * _hashes;
+            if (_norm == IVector::Norm::NORM_INF) {
+                _axes.assign(axes, axes + funcs);
+            } else {
+                _proj.assign(proj, proj + funcs * _dim);
+            }
+        }
+
+        IVector::Norm getNorm() const {
+            return _norm;
+        }
+
+        size_t getTables() const {
+            return _tables;
+        }
+
+        size_t getHashes() const {
+            return _hashes;
+        }
+
+        std::vector<double> const & getProjections() const {
+            return _proj;
+        }
+
+        std::vector<size_t> const & getAxes() const {
+            return _axes;
+        }
+
+        std::vector<double> const & getShifts() const {
+            return _shifts;
+        }
+
+        // keys[id * tables + table] for every indexed point
+        void exportKeys(std::vector<uint64_t> & keys, size_t count) const {
+            keys.assign(count * _tables, 0);
+            for (size_t t = 0; t < _tables; t++) {
+                for (auto const & bucket : _buckets[t]) {
+                    for (auto id : bucket.second) {
+                        keys[id * _tables + t] = bucket.first;
+                    }
+                }
+            }
+        }
+
+        void insertKey(size_t table, uint64_t key, size_t id) {
+            _buckets[table][key].push_back(id);
+        }
+
+        double getAccuracy() const {
+            return _accuracy;
+        }
+
+        // index answers queries with the same norm and not greater tolerance
+        bool covers(IVector::Norm norm, double accuracy) const {
+            return norm == _norm && accuracy <= _accuracy;
+        }
+
+        void insert(double const * point, size_t id) {
+            for (size_t t = 0; t < _tables; t++) {
+                _buckets[t][key(point, t)].push_back(id);
+            }
+        }
+
+        // removes point with given id, ids after it are shifted down like in the set storage
+        void erase(double const * point, size_t id) {
+            for (size_t t = 0; t < _tables; t++) {
+                auto bucket = _buckets[t].find(key(point, t));
+                if (bucket == _buckets[t].end()) {
+                    continue;
+                }
+                std::vector<size_t> & ids = bucket->second;
+                ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+                if (ids.empty()) {
+                    _buckets[t].erase(bucket);
+                }
+            }
+            for (auto & table : _buckets) {
+                for (auto & bucket : table) {
+                    for (auto & cur_id : bucket.second) {
+                        if (cur_id > id) {
+                            cur_id--;
+                        }
+                    }
+                }
+            }
+        }
+
+        // makes room for a point inserted with given id in the middle of the set storage
+        void shiftFrom(size_t id) {
+            for (auto & table : _buckets) {
+                for (auto & bucket : table) {
+                    for (auto & cur_id : bucket.second) {
+                        if (cur_id >= id) {
+                            cur_id++;
+                        }
+                    }
+                }
+            }
+        }
+
+        // sorted ids of points sharing at least one bucket with the given point
+        void candidates(double const * point, std::vector<size_t> & result) const {
+            result.clear();
+            for (size_t t = 0; t < _tables; t++) {
+                auto bucket = _buckets[t].find(key(point, t));
+                if (bucket != _buckets[t].end()) {
+                    result.insert(result.end(), bucket->second.begin(), bucket->second.end());
+                }
+            }
+            std::sort(result.begin(), result.end());
+            result.erase(std::unique(result.begin(), result.end()), result.end());
+        }
+
+        void clear() {
+            for (auto & table : _buckets) {
+                table.clear();
+            }
+        }
+
+    private:
+        uint64_t key(double const * point, size_t table) const {
+            uint64_t res = table;
+            for (size_t h = table * _hashes; h < (table + 1) * _hashes; h++) {
+                double value;
+                if (_norm == IVector::Norm::NORM_INF) {
+                    value = point[_axes[h]];
+                } else {
+                    value = 0;
+                    double const * proj = &_proj[h * _dim];
+                    for (size_t j = 0; j < _dim; j++) {
+                        value += proj[j] * point[j];
+                    }
+                }
+                // bit pattern of the cell number is hashed to stay defined for huge projections
+                double cell = std::floor((value + _shifts[h]) / _width) + 0.0;
+                uint64_t bits;
+                std::memcpy(&bits, &cell, sizeof(bits));
+                res ^= bits + 0x9e3779b97f4a7c15ULL + (res << 6) + (res >> 2);
+            }
+            return res;
+        }
+
+        size_t _dim;
+        IVector::Norm _norm;
+        double _accuracy;
+        double _width;
+        size_t _tables;
+        size_t _hashes;
+        std::vector<double> _proj;
+        std::vector<size_t> _axes;
+        std::vector<double> _shifts;
+        std::vector<std::unordered_map<uint64_t, std::vector<size_t>>> _buckets;
+    };
+}
+
+#endif /* LSH_INDEX_H */
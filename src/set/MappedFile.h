@@ -0,0 +1,122 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+    // read-only mapping of a whole file
+    class MappedFile {
+    public:
+        MappedFile() = default;
+
+        bool open(char const * path) {
+            close();
+#ifdef _WIN32
+            _file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (_file == INVALID_HANDLE_VALUE) {
+                return false;
+            }
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+                close();
+                return false;
+            }
+            _size = (size_t)size.QuadPart;
+            _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (_mapping == nullptr) {
+                close();
+                return false;
+            }
+            _data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+            _fd = ::open(path, O_RDONLY);
+            if (_fd < 0) {
+                return false;
+            }
+            struct stat info;
+            if (fstat(_fd, &info) != 0 || info.st_size == 0) {
+                close();
+                return false;
+            }
+            _size = (size_t)info.st_size;
+            _data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, _fd, 0);
+            if (_data == MAP_FAILED) {
+                _data = nullptr;
+            }
+#endif
+            if (_data == nullptr) {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        void close() {
+#ifdef _WIN32
+            if (_data != nullptr) {
+                UnmapViewOfFile(_data);
+            }
+            if (_mapping != nullptr) {
+                CloseHandle(_mapping);
+            }
+            if (_file != INVALID_HANDLE_VALUE) {
+                CloseHandle(_file);
+            }
+            _mapping = nullptr;
+            _file = INVALID_HANDLE_VALUE;
+#else
+            if (_data != nullptr) {
+                munmap(_data, _size);
+            }
+            if (_fd >= 0) {
+                ::close(_fd);
+            }
+            _fd = -1;
+#endif
+            _data = nullptr;
+            _size = 0;
+        }
+
+        void const * data() const {
+            return _data;
+        }
+
+        size_t size() const {
+            return _size;
+        }
+
+        ~MappedFile() {
+            close();
+        }
+
+    private:
+        MappedFile(MappedFile const &)            = delete;
+        MappedFile& operator=(MappedFile const &) = delete;
+
+        void * _data {nullptr};
+        size_t _size {0};
+#ifdef _WIN32
+        HANDLE _file {INVALID_HANDLE_VALUE};
+        HANDLE _mapping {nullptr};
+#else
+        int _fd {-1};
+#endif
+    };
+}
+
+#endif /* MAPPED_FILE_H */
@@ -0,0 +1,135 @@
+#ifndef PACKED_POINTS_H
+#define PACKED_POINTS_H
+
+#include "include/ISet.h"
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+    // coordinates of a set in a compressed format: floats or 32-bit codes of multiples of step from the origin;
+    // stored points are exactly their decoded values, so encoding a decoded point gives it back unchanged
+    class PackedPoints {
+    public:
+        PackedPoints(size_t dim, ISet::StorageFormat format, double const * origin, double step) :
+                _dim(dim),
+                _format(format),
+                _origin(origin, origin + dim),
+                _step(step) {
+        }
+
+        // storage with the same format and quantization grid
+        PackedPoints emptyCopy() const {
+            return PackedPoints(_dim, _format, _origin.data(), _step);
+        }
+
+        ISet::StorageFormat getFormat() const {
+            return _format;
+        }
+
+        size_t size() const {
+            return (_format == ISet::StorageFormat::FLOAT32 ? _floats.size() : _codes.size()) / _dim;
+        }
+
+        bool sameCodec(PackedPoints const & other) const {
+            return _dim == other._dim && _format == other._format && _origin == other._origin && _step == other._step;
+        }
+
+        // replaces coordinates by the nearest stored values, false if some of them are out of range
+        bool round(double * point) const {
+            for (size_t i = 0; i < _dim; i++) {
+                if (_format == ISet::StorageFormat::FLOAT32) {
+                    if (std::fabs(point[i]) > FLT_MAX) {
+                        return false;
+                    }
+                    point[i] = (double)(float)point[i];
+                } else {
+                    double code = std::round((point[i] - _origin[i]) / _step);
+                    if (code < INT32_MIN || code > INT32_MAX) {
+                        return false;
+                    }
+                    point[i] = _origin[i] + code * _step;
+                }
+            }
+            return true;
+        }
+
+        // largest difference between a coordinate not greater than magnitude in absolute value and its stored value:
+        // half a float unit in the last place, or half the step plus the double rounding of the decoded value
+        double error(double magnitude) const {
+            if (_format == ISet::StorageFormat::FLOAT32) {
+                return magnitude * (FLT_EPSILON / 2) + FLT_MIN;
+            }
+            return _step / 2 + (magnitude + _step) * DBL_EPSILON;
+        }
+
+        // point must be rounded already
+        void insert(size_t pos, double const * point) {
+            if (_format == ISet::StorageFormat::FLOAT32) {
+                _floats.insert(_floats.begin() + pos * _dim, _dim, 0.0f);
+                for (size_t i = 0; i < _dim; i++) {
+                    _floats[pos * _dim + i] = (float)point[i];
+                }
+            } else {
+                _codes.insert(_codes.begin() + pos * _dim, _dim, 0);
+                for (size_t i = 0; i < _dim; i++) {
+                    _codes[pos * _dim + i] = (int32_t)std::round((point[i] - _origin[i]) / _step);
+                }
+            }
+        }
+
+        void erase(size_t ind) {
+            if (_format == ISet::StorageFormat::FLOAT32) {
+                _floats.erase(_floats.begin() + ind * _dim, _floats.begin() + (ind + 1) * _dim);
+            } else {
+                _codes.erase(_codes.begin() + ind * _dim, _codes.begin() + (ind + 1) * _dim);
+            }
+        }
+
+        // element k of the result is element perm[k] now
+        void reorder(std::vector<size_t> const & perm) {
+            reorder(_floats, perm);
+            reorder(_codes, perm);
+        }
+
+        // plain conversion loops, vectorized by the compiler
+        void decode(size_t ind, double * point) const {
+            if (_format == ISet::StorageFormat::FLOAT32) {
+                float const * cur = _floats.data() + ind * _dim;
+                for (size_t i = 0; i < _dim; i++) {
+                    point[i] = cur[i];
+                }
+            } else {
+                int32_t const * cur = _codes.data() + ind * _dim;
+                for (size_t i = 0; i < _dim; i++) {
+                    point[i] = _origin[i] + cur[i] * _step;
+                }
+            }
+        }
+
+    private:
+        template <class T>
+        void reorder(std::vector<T> & values, std::vector<size_t> const & perm) {
+            if (values.empty()) {
+                return;
+            }
+            std::vector<T> result(values.size());
+            for (size_t k = 0; k < perm.size(); k++) {
+                for (size_t i = 0; i < _dim; i++) {
+                    result[k * _dim + i] = values[perm[k] * _dim + i];
+                }
+            }
+            values.swap(result);
+        }
+
+        size_t _dim;
+        ISet::StorageFormat _format;
+        std::vector<double> _origin;
+        double _step;
+        std::vector<float> _floats;
+        std::vector<int32_t> _codes;
+    };
+}
+
+#endif /* PACKED_POINTS_H */
@@ -0,0 +1,127 @@
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include "include/IVector.h"
+#include "Distance.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace {
+    // 0 means all hardware threads, no more threads than items
+    inline size_t workerCount(size_t threads, size_t count) {
+        if (threads == 0) {
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        }
+        return std::max<size_t>(1, std::min(threads, count));
+    }
+
+    // body(partial, begin, end) fills one partial result per contiguous range of [0, count),
+    // ranges go to separate threads and partials stay in range order, so merging them is deterministic
+    template <class Partial, class Body>
+    void reduceRanges(size_t count, size_t threads, std::vector<Partial> & partials, Body body) {
+        threads = workerCount(threads, count);
+        if (threads == 1) {
+            body(partials[0], 0, count);
+            return;
+        }
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.push_back(std::thread(body, std::ref(partials[t]), t * count / threads, (t + 1) * count / threads));
+        }
+        for (auto & worker : workers) {
+            worker.join();
+        }
+    }
+
+    // per-axis bounds and sums and sums of pairwise products of coordinates shifted by a common point,
+    // the shift keeps the covariance accurate for elements far from the origin
+    class Moments {
+    public:
+        Moments(size_t dim, double const * shift) :
+                _dim(dim),
+                _shift(shift),
+                _min(dim, INFINITY),
+                _max(dim, -INFINITY),
+                _sum(dim, 0),
+                _products(dim * dim, 0) {
+        }
+
+        void add(double const * points, size_t begin, size_t end) {
+            std::vector<double> diff(_dim);
+            for (size_t ind = begin; ind < end; ind++) {
+                double const * cur = points + ind * _dim;
+                for (size_t i = 0; i < _dim; i++) {
+                    _min[i] = std::min(_min[i], cur[i]);
+                    _max[i] = std::max(_max[i], cur[i]);
+                    diff[i] = cur[i] - _shift[i];
+                    _sum[i] += diff[i];
+                }
+                // upper triangle only, the inner loop runs over contiguous memory
+                for (size_t i = 0; i < _dim; i++) {
+                    double * row = _products.data() + i * _dim;
+                    for (size_t j = i; j < _dim; j++) {
+                        row[j] += diff[i] * diff[j];
+                    }
+                }
+            }
+            _count += end - begin;
+        }
+
+        void merge(Moments const & other) {
+            for (size_t i = 0; i < _dim; i++) {
+                _min[i] = std::min(_min[i], other._min[i]);
+                _max[i] = std::max(_max[i], other._max[i]);
+                _sum[i] += other._sum[i];
+            }
+            for (size_t k = 0; k < _products.size(); k++) {
+                _products[k] += other._products[k];
+            }
+            _count += other._count;
+        }
+
+        // covariance is divided by the number of elements minus one, zero for a single element
+        void result(std::vector<double> & min, std::vector<double> & max, std::vector<double> & mean,
+                    std::vector<double> & covariance) const {
+            min = _min;
+            max = _max;
+            mean.resize(_dim);
+            for (size_t i = 0; i < _dim; i++) {
+                mean[i] = _shift[i] + _sum[i] / _count;
+            }
+            covariance.assign(_dim * _dim, 0);
+            if (_count < 2) {
+                return;
+            }
+            for (size_t i = 0; i < _dim; i++) {
+                for (size_t j = i; j < _dim; j++) {
+                    double value = (_products[i * _dim + j] - _sum[i] * _sum[j] / _count) / (_count - 1);
+                    covariance[i * _dim + j] = value;
+                    covariance[j * _dim + i] = value;
+                }
+            }
+        }
+
+    private:
+        size_t _dim;
+        double const * _shift;
+        size_t _count {0};
+        std::vector<double> _min;
+        std::vector<double> _max;
+        std::vector<double> _sum;
+        std::vector<double> _products;
+    };
+
+    // bin of value among bins equal parts of [low, high], the upper bound goes to the last bin
+    inline size_t histogramBin(double value, double low, double high, size_t bins) {
+        if (!(high > low)) {
+            return 0;
+        }
+        double bin = std::floor((value - low) / (high - low) * bins);
+        return bin <= 0 ? 0 : bin >= bins ? bins - 1 : (size_t)bin;
+    }
+}
+
+#endif /* REDUCE_H */
@@ -0,0 +1,77 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "include/ISet.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace {
+    // on-disk layout of a saved set (native byte order):
+    //   header
+    //   (elements are stored in the order of the set, so ordered sets need no sorting after loading)
+    //   count * dim doubles of coordinates
+    //   optional LSH index: projections (dim doubles per hash) or axes (one uint64 per hash) for NORM_INF,
+    //   shifts (one double per hash), keys (tables uint64 per element)
+    struct SnapshotHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t dim;
+        uint64_t count;
+        uint32_t flags;
+        uint32_t norm;
+        double tolerance;
+        double recall;
+        uint64_t hashes;
+        uint64_t tables;
+        uint64_t seed;
+        uint64_t index_offset;
+        uint32_t order;
+        uint32_t reserved;
+        double cell_size;
+    };
+
+    static_assert(sizeof(SnapshotHeader) % sizeof(double) == 0, "coordinates must stay aligned after the header");
+
+    char const SNAPSHOT_MAGIC[4]    = {'I', 'S', 'E', 'T'};
+    uint32_t const SNAPSHOT_VERSION = 2;
+    uint32_t const SNAPSHOT_LSH     = 1;
+    uint64_t const SNAPSHOT_MAX_FUNCS = 4096;
+
+    inline bool checkSnapshotHeader(SnapshotHeader const & header, size_t file_size) {
+        if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.version != SNAPSHOT_VERSION) {
+            return false;
+        }
+        if (file_size < sizeof(SnapshotHeader) || (header.count == 0) != (header.dim == 0)) {
+            return false;
+        }
+        if (header.dim != 0 && header.count > (file_size - sizeof(SnapshotHeader)) / sizeof(double) / header.dim) {
+            return false;
+        }
+        if (header.order > (uint32_t)ISet::StorageOrder::HILBERT ||
+                (header.order != (uint32_t)ISet::StorageOrder::INSERTION && !(header.cell_size > 0 && !std::isinf(header.cell_size)))) {
+            return false;
+        }
+        if (header.flags & SNAPSHOT_LSH) {
+            uint64_t funcs = header.tables * header.hashes;
+            uint32_t const norm_inf = (uint32_t)IVector::Norm::NORM_INF;
+            if (header.norm > norm_inf || header.tables == 0 || header.tables > SNAPSHOT_MAX_FUNCS ||
+                    header.hashes == 0 || header.hashes > SNAPSHOT_MAX_FUNCS) {
+                return false;
+            }
+            // the same parameters setApproximateIndex accepts
+            if (!(header.tolerance > 0) || !(header.recall > 0 && header.recall < 1)) {
+                return false;
+            }
+            uint64_t index_size = funcs * sizeof(double) * (header.norm == norm_inf ? 2 : header.dim + 1) +
+                    header.count * header.tables * sizeof(uint64_t);
+            if (header.index_offset % sizeof(double) != 0 || header.index_offset > file_size ||
+                    index_size > file_size - header.index_offset) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,433 @@
+#ifndef STREAM_DEDUP_H
+#define STREAM_DEDUP_H
+
+#include "include/ISet.h"
+#include "Distance.h"
+#include <stdio.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+
+namespace {
+    // external deduplication: input is read in chunks that fit the memory budget; input that fits one chunk is
+    // deduplicated by a tolerance sweep in memory, otherwise every chunk is sorted along the sweep axis and split
+    // into slabs of that axis, each slab keeps its pieces of all chunks in one temporary file;
+    // slabs are merged one after another into a single sweep, which keeps a point unless it is within tolerance
+    // of a point kept before it, so every input point is either kept or close to a kept one
+    class StreamDedup {
+    public:
+        StreamDedup(size_t dim, IVector::Norm norm, double accuracy, size_t memory_budget,
+                    ISet::PushPoints push, void * push_context) :
+                _dim(dim),
+                _norm(norm),
+                _accuracy(accuracy),
+                _push(push),
+                _push_context(push_context) {
+            size_t point_size = _dim * sizeof(double);
+            // chunk and its sorted copy share the budget
+            _chunk_capacity = std::max<size_t>(1, memory_budget / (2 * point_size));
+            // while merging an eighth of the budget goes to the block of merged points, three eighths to the window
+            // of points kept in memory, a quarter to reading the window spilled to disk and a quarter to slab buffers
+            _block_capacity = std::max<size_t>(1, memory_budget / 8 / point_size);
+            _window_capacity = std::max<size_t>(1, memory_budget / 8 * 3 / point_size);
+            _scan_capacity = std::max<size_t>(1, memory_budget / 4 / point_size);
+            _buffers_size = std::max(memory_budget / 4, point_size);
+        }
+
+        ~StreamDedup() {
+            for (auto & slab : _slabs) {
+                if (slab.file != nullptr) {
+                    fclose(slab.file);
+                }
+            }
+            if (_window_file != nullptr) {
+                fclose(_window_file);
+            }
+        }
+
+        ReturnCode run(ISet::PullPoints pull, void * pull_context, size_t & result_size) {
+            result_size = 0;
+            std::vector<double> chunk;
+            std::vector<double> sorted;
+            bool finished = false;
+            while (!finished) {
+                ReturnCode r_code = readChunk(pull, pull_context, chunk, finished);
+                if (r_code != ReturnCode::RC_SUCCESS) {
+                    return r_code;
+                }
+                if (chunk.empty()) {
+                    continue;
+                }
+                if (_sweep_axis == NO_AXIS) {
+                    chooseSweepAxis(chunk);
+                }
+                if (finished && _slabs.empty()) {
+                    dedupChunk(chunk, sorted);
+                    return pushAll(sorted, result_size);
+                }
+                sortChunk(chunk, sorted);
+                if (_slabs.empty()) {
+                    chooseSlabs(sorted);
+                }
+                if ((r_code = spill(sorted)) != ReturnCode::RC_SUCCESS) {
+                    return r_code;
+                }
+            }
+            return merge(result_size);
+        }
+
+    private:
+        static size_t const NO_AXIS = (size_t)-1;
+        static size_t const SLABS = 16;
+
+        // sorted piece of one chunk within a slab file
+        struct Segment {
+            fpos_t pos;
+            size_t left;
+            std::vector<double> buffer;
+            size_t next;
+        };
+
+        struct Slab {
+            FILE * file;
+            std::vector<Segment> segments;
+        };
+
+        ReturnCode readChunk(ISet::PullPoints pull, void * pull_context, std::vector<double> & chunk, bool & finished) {
+            chunk.resize(_chunk_capacity * _dim);
+            size_t count = 0;
+            while (count < _chunk_capacity) {
+                size_t got = pull(pull_context, chunk.data() + count * _dim, _chunk_capacity - count);
+                if (got == 0) {
+                    finished = true;
+                    break;
+                }
+                if (got > _chunk_capacity - count) {
+                    return ReturnCode::RC_OUT_OF_BOUNDS;
+                }
+                // points which ISet::insert would reject are skipped
+                size_t end = count + got;
+                for (size_t i = count; i < end; i++) {
+                    double const * cur = chunk.data() + i * _dim;
+                    bool valid = true;
+                    for (size_t j = 0; j < _dim && valid; j++) {
+                        valid = !std::isnan(cur[j]) && !std::isinf(cur[j]);
+                    }
+                    if (valid) {
+                        std::copy(cur, cur + _dim, chunk.begin() + count * _dim);
+                        count++;
+                    }
+                }
+            }
+            chunk.resize(count * _dim);
+            return ReturnCode::RC_SUCCESS;
+        }
+
+        // axis with the widest spread in the first chunk separates points best
+        void chooseSweepAxis(std::vector<double> const & chunk) {
+            size_t count = chunk.size() / _dim;
+            double best = -1;
+            for (size_t j = 0; j < _dim; j++) {
+                double min = chunk[j], max = chunk[j];
+                for (size_t i = 1; i < count; i++) {
+                    min = std::min(min, chunk[i * _dim + j]);
+                    max = std::max(max, chunk[i * _dim + j]);
+                }
+                if (max - min > best) {
+                    best = max - min;
+                    _sweep_axis = j;
+                }
+            }
+        }
+
+        std::vector<size_t> sweepOrder(std::vector<double> const & chunk) const {
+            size_t count = chunk.size() / _dim;
+            std::vector<size_t> order(count);
+            for (size_t i = 0; i < count; i++) {
+                order[i] = i;
+            }
+            size_t axis = _sweep_axis;
+            size_t dim = _dim;
+            std::stable_sort(order.begin(), order.end(), [&chunk, axis, dim](size_t a, size_t b) {
+                return chunk[a * dim + axis] < chunk[b * dim + axis];
+            });
+            return order;
+        }
+
+        // keeps the first point of every group within tolerance, result is sorted along the sweep axis
+        void dedupChunk(std::vector<double> const & chunk, std::vector<double> & kept) {
+            kept.clear();
+            for (auto ind : sweepOrder(chunk)) {
+                double const * cur = chunk.data() + ind * _dim;
+                bool duplicate = false;
+                // any norm of the difference is not less than its sweep coordinate
+                for (size_t k = kept.size() / _dim; k > 0 && !duplicate; k--) {
+                    double const * prev = kept.data() + (k - 1) * _dim;
+                    if (beyondTolerance(cur[_sweep_axis] - prev[_sweep_axis], _accuracy)) {
+                        break;
+                    }
+                    duplicate = pointsEqual(prev, cur, _dim, _norm, _accuracy);
+                }
+                if (!duplicate) {
+                    kept.insert(kept.end(), cur, cur + _dim);
+                }
+            }
+        }
+
+        // chunk sorted along the sweep axis without exact copies: a copy is close to whatever its original is,
+        // while a point dropped for being close to another one could lose it later in the merge
+        void sortChunk(std::vector<double> const & chunk, std::vector<double> & sorted) {
+            sorted.clear();
+            size_t group = 0;
+            for (auto ind : sweepOrder(chunk)) {
+                double const * cur = chunk.data() + ind * _dim;
+                size_t count = sorted.size() / _dim;
+                if (count == 0 || sorted[(count - 1) * _dim + _sweep_axis] != cur[_sweep_axis]) {
+                    group = count;
+                }
+                bool copy = false;
+                for (size_t k = group; k < count && !copy; k++) {
+                    copy = std::equal(cur, cur + _dim, sorted.begin() + k * _dim);
+                }
+                if (!copy) {
+                    sorted.insert(sorted.end(), cur, cur + _dim);
+                }
+            }
+        }
+
+        // slab boundaries are quantiles of the sweep coordinate in the first chunk
+        void chooseSlabs(std::vector<double> const & sorted) {
+            size_t count = sorted.size() / _dim;
+            _slabs.assign(SLABS, Slab {nullptr, std::vector<Segment>()});
+            for (size_t s = 1; s < SLABS; s++) {
+                _bounds.push_back(sorted[(s * count / SLABS) * _dim + _sweep_axis]);
+            }
+        }
+
+        ReturnCode spill(std::vector<double> const & sorted) {
+            size_t count = sorted.size() / _dim;
+            for (size_t first = 0; first < count;) {
+                double const * cur = sorted.data() + first * _dim;
+                size_t s = std::upper_bound(_bounds.begin(), _bounds.end(), cur[_sweep_axis]) - _bounds.begin();
+                size_t last = first + 1;
+                while (last < count && (s + 1 == SLABS || sorted[last * _dim + _sweep_axis] < _bounds[s])) {
+                    last++;
+                }
+                Slab & slab = _slabs[s];
+                if (slab.file == nullptr && (slab.file = tmpfile()) == nullptr) {
+                    return ReturnCode::RC_OPEN_FILE;
+                }
+                Segment segment;
+                segment.left = last - first;
+                segment.next = 0;
+                if (fseek(slab.file, 0, SEEK_END) != 0 || fgetpos(slab.file, &segment.pos) != 0) {
+                    return ReturnCode::RC_OPEN_FILE;
+                }
+                slab.segments.push_back(segment);
+                size_t coords = (last - first) * _dim;
+                if (fwrite(cur, sizeof(double), coords, slab.file) != coords) {
+                    return ReturnCode::RC_OPEN_FILE;
+                }
+                first = last;
+            }
+            return ReturnCode::RC_SUCCESS;
+        }
+
+        bool refill(FILE * file, Segment & segment, size_t capacity) {
+            size_t count = std::min(segment.left, capacity);
+            segment.buffer.resize(count * _dim);
+            segment.next = 0;
+            if (count == 0 || fsetpos(file, &segment.pos) != 0 ||
+                    fread(segment.buffer.data(), sizeof(double), count * _dim, file) != count * _dim ||
+                    fgetpos(file, &segment.pos) != 0) {
+                segment.buffer.clear();
+                return false;
+            }
+            segment.left -= count;
+            return true;
+        }
+
+        // slabs cover consecutive ranges of the sweep coordinate, so merging them in turn gives one sorted stream
+        ReturnCode merge(size_t & result_size) {
+            typedef std::pair<double, size_t> Head;
+            for (auto & slab : _slabs) {
+                if (slab.segments.empty()) {
+                    continue;
+                }
+                size_t capacity = std::max<size_t>(1, _buffers_size / (slab.segments.size() * _dim * sizeof(double)));
+                std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+                for (size_t k = 0; k < slab.segments.size(); k++) {
+                    if (refill(slab.file, slab.segments[k], capacity)) {
+                        heads.push(Head(slab.segments[k].buffer[_sweep_axis], k));
+                    }
+                }
+                while (!heads.empty()) {
+                    Segment & segment = slab.segments[heads.top().second];
+                    heads.pop();
+                    double const * cur = segment.buffer.data() + segment.next * _dim;
+                    _block.insert(_block.end(), cur, cur + _dim);
+                    if (_block.size() == _block_capacity * _dim) {
+                        ReturnCode r_code = sweepBlock(result_size);
+                        if (r_code != ReturnCode::RC_SUCCESS) {
+                            return r_code;
+                        }
+                    }
+                    segment.next++;
+                    if (segment.next * _dim < segment.buffer.size() || refill(slab.file, segment, capacity)) {
+                        heads.push(Head(segment.buffer[segment.next * _dim + _sweep_axis], &segment - slab.segments.data()));
+                    }
+                }
+                std::vector<Segment>().swap(slab.segments);
+                fclose(slab.file);
+                slab.file = nullptr;
+            }
+            return sweepBlock(result_size);
+        }
+
+        // the sweep over a block of merged points: kept points close along the sweep axis form the window,
+        // its older part goes to a temporary file when it outgrows the budget and is checked for the whole block
+        // in one pass; that gives the same result as checking point by point, since points kept within the block
+        // are all in memory
+        ReturnCode sweepBlock(size_t & result_size) {
+            size_t count = _block.size() / _dim;
+            if (count == 0) {
+                return ReturnCode::RC_SUCCESS;
+            }
+            std::vector<uint8_t> covered(count, 0);
+            ReturnCode r_code = scanWindowFile(covered);
+            if (r_code != ReturnCode::RC_SUCCESS) {
+                return r_code;
+            }
+            double first = _block[_sweep_axis];
+            while (_window_first < _window.size() && beyondTolerance(first - _window[_window_first + _sweep_axis], _accuracy)) {
+                _window_first += _dim;
+            }
+
+            std::vector<double> kept;
+            for (size_t i = 0; i < count; i++) {
+                double const * cur = _block.data() + i * _dim;
+                bool duplicate = covered[i] != 0;
+                for (size_t k = _window.size(); k > _window_first && !duplicate; k -= _dim) {
+                    double const * prev = _window.data() + k - _dim;
+                    if (beyondTolerance(cur[_sweep_axis] - prev[_sweep_axis], _accuracy)) {
+                        break;
+                    }
+                    duplicate = pointsEqual(prev, cur, _dim, _norm, _accuracy);
+                }
+                if (!duplicate) {
+                    _window.insert(_window.end(), cur, cur + _dim);
+                    kept.insert(kept.end(), cur, cur + _dim);
+                }
+            }
+            _block.clear();
+            if ((r_code = spillWindow()) != ReturnCode::RC_SUCCESS) {
+                return r_code;
+            }
+            return pushAll(kept, result_size);
+        }
+
+        // marks points of the block close to the window part on disk, windows read entirely beyond tolerance
+        // of the first point of the block are dropped from the file
+        ReturnCode scanWindowFile(std::vector<uint8_t> & covered) {
+            if (_window_file_count == 0) {
+                return ReturnCode::RC_SUCCESS;
+            }
+            size_t count = _block.size() / _dim;
+            double first = _block[_sweep_axis];
+            std::vector<double> buffer;
+            fpos_t pos = _window_file_start;
+            bool dropping = true;
+            for (size_t left = _window_file_count; left > 0;) {
+                size_t got = std::min(left, _scan_capacity);
+                buffer.resize(got * _dim);
+                if (fsetpos(_window_file, &pos) != 0 ||
+                        fread(buffer.data(), sizeof(double), got * _dim, _window_file) != got * _dim ||
+                        fgetpos(_window_file, &pos) != 0) {
+                    return ReturnCode::RC_OPEN_FILE;
+                }
+                left -= got;
+                dropping = dropping && beyondTolerance(first - buffer[(got - 1) * _dim + _sweep_axis], _accuracy);
+                if (dropping) {
+                    _window_file_start = pos;
+                    _window_file_count = left;
+                    continue;
+                }
+                for (size_t k = 0; k < got; k++) {
+                    double const * prev = buffer.data() + k * _dim;
+                    // block points close along the sweep axis come first
+                    for (size_t i = 0; i < count; i++) {
+                        double const * cur = _block.data() + i * _dim;
+                        if (beyondTolerance(cur[_sweep_axis] - prev[_sweep_axis], _accuracy)) {
+                            break;
+                        }
+                        covered[i] |= pointsEqual(prev, cur, _dim, _norm, _accuracy) ? 1 : 0;
+                    }
+                }
+            }
+            if (_window_file_count == 0) {
+                fclose(_window_file);
+                _window_file = nullptr;
+            }
+            return ReturnCode::RC_SUCCESS;
+        }
+
+        // the oldest points of the window over its capacity are appended to the file, which keeps it sorted
+        ReturnCode spillWindow() {
+            size_t count = (_window.size() - _window_first) / _dim;
+            if (count > _window_capacity) {
+                size_t moved = (count - _window_capacity) * _dim;
+                if (_window_file == nullptr) {
+                    if ((_window_file = tmpfile()) == nullptr || fgetpos(_window_file, &_window_file_start) != 0) {
+                        return ReturnCode::RC_OPEN_FILE;
+                    }
+                }
+                if (fseek(_window_file, 0, SEEK_END) != 0 ||
+                        fwrite(_window.data() + _window_first, sizeof(double), moved, _window_file) != moved) {
+                    return ReturnCode::RC_OPEN_FILE;
+                }
+                _window_file_count += moved / _dim;
+                _window_first += moved;
+            }
+            if (_window_first > _window.size() / 2) {
+                _window.erase(_window.begin(), _window.begin() + _window_first);
+                _window_first = 0;
+            }
+            return ReturnCode::RC_SUCCESS;
+        }
+
+        ReturnCode pushAll(std::vector<double> const & points, size_t & result_size) {
+            size_t count = points.size() / _dim;
+            if (count == 0) {
+                return ReturnCode::RC_SUCCESS;
+            }
+            result_size += count;
+            return _push(_push_context, points.data(), count);
+        }
+
+        size_t _dim;
+        IVector::Norm _norm;
+        double _accuracy;
+        ISet::PushPoints _push;
+        void * _push_context;
+        size_t _chunk_capacity;
+        size_t _block_capacity;
+        size_t _window_capacity;
+        size_t _scan_capacity;
+        size_t _buffers_size;
+        size_t _sweep_axis {NO_AXIS};
+        std::vector<double> _bounds;
+        std::vector<Slab> _slabs;
+        std::vector<double> _block;
+        // kept points from _window_first on, the older ones are in the file
+        std::vector<double> _window;
+        size_t _window_first {0};
+        FILE * _window_file {nullptr};
+        fpos_t _window_file_start;
+        size_t _window_file_count {0};
+    };
+}
+
+#endif /* STREAM_DEDUP_H */
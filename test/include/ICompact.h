@@ -2,16 +2,56 @@
 #define ICOMPACT_H
 
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include "IVector.h"
 
+class ISet;
+
 class DECLSPEC ICompact {
 public:
+    // order of the lattice points: lexicographic over the axes of the direction, the faster ones first;
+    // serpentine, with every row reversed after the previous one, so consecutive points are neighbours;
+    // along the Hilbert curve; or tile after tile of blockSize points per axis, lexicographic in both
+    enum class Traversal {
+        LEXICOGRAPHIC,
+        SERPENTINE,
+        HILBERT,
+        BLOCKED
+    };
+
+    // samples of the compact: Sobol and Halton low-discrepancy sequences, Latin hypercube with one sample in every
+    // of total slices along each axis, and stratified, one sample in every cell of the finest cubic grid of at most
+    // total cells in turn
+    enum class Sampling {
+        SOBOL,
+        HALTON,
+        LATIN_HYPERCUBE,
+        STRATIFIED
+    };
+
     class Iterator {
     public:
         virtual IVector* getPoint() const = 0;
+        // copies getDim() coordinates of the current point into point without allocations
+        virtual ReturnCode getPoint(double* point) const = 0;
+        // copies up to maxCount points one after another from the current one on and steps past them,
+        // returns the number of copied points (0 at the end)
+        virtual size_t getPoints(double* points, size_t maxCount) = 0;
+        virtual size_t getDim() const = 0;
+        // points are numbered in the order of the walk from 0 to getCount() - 1
+        virtual size_t getCount() const = 0;
+        virtual size_t getPosition() const = 0;
+        virtual ReturnCode seek(size_t position) = 0;
+        // parts iterators walking disjoint consecutive ranges of the points of this one, each from its first point;
+        // the caller deletes them, their direction cannot be changed
+        virtual ReturnCode split(size_t parts, std::vector<Iterator*>& iterators) const = 0;
         // change order of step
         virtual ReturnCode setDirection(std::vector<size_t> const& direction) = 0;
+        // the current point stays and is renumbered in the new order; not for split parts, and the Hilbert order
+        // needs at most 10 axes and at most 64 bits of the curve key
+        virtual ReturnCode setTraversal(Traversal traversal, size_t blockSize = 8) = 0;
+        virtual Traversal getTraversal() const = 0;
         // adds step to current value in Iterator
         virtual ReturnCode doStep() = 0;
 
@@ -27,14 +67,91 @@ public:
     static ICompact* _union(ICompact const* comp1, ICompact const* comp2, double tolerance, ILogger* logger = nullptr);
     static ICompact* convex(ICompact const* comp1, ICompact const* comp2, double tolerance, ILogger* logger = nullptr);
     static ICompact* intersection(ICompact const* comp1, ICompact const* comp2, double tolerance, ILogger* logger = nullptr);
+    // smallest compact containing all elements of the set
+    static ICompact* createBoundingBox(ISet const* set, ILogger* logger = nullptr);
+    // numbers of the compacts holding every point of count ones laid out one after another:
+    // ids[offsets[k]..offsets[k + 1]) for point k in increasing order; the compacts are put in an R-tree for the call
+    static ReturnCode classify(std::vector<ICompact const*> const& compacts, double const* points, size_t count,
+                               std::vector<size_t>& offsets, std::vector<size_t>& ids, ILogger* logger = nullptr);
 
     virtual Iterator* begin(IVector const* step) = 0;
     virtual Iterator* end(IVector const* step)   = 0;
 
+    class Lattice;
+    // points of begin(step) as a range of standard random access iterators; empty if the step is wrong
+    Lattice lattice(IVector const* step) const;
+
+    // fn(accumulator, point) at every point begin + k * step, in chunks of chunkSize consecutive points taken by
+    // threads as they get free (0 means all hardware threads and an automatic size); every chunk is folded
+    // from init and chunks are combined in order by combine(accumulator, other), so the result is the same
+    // for any number of threads; fn is called inline for points decoded a chunk at a time and must not throw
+    template <class T, class Fn, class Combine>
+    ReturnCode parallelReduce(IVector const* step, T const& init, Fn fn, Combine combine, T& result,
+                              size_t threads = 0, size_t chunkSize = 0);
+    // fn(point, position) at every point with its number in the order of the walk
+    template <class Fn>
+    ReturnCode parallelForEach(IVector const* step, Fn fn, size_t threads = 0, size_t chunkSize = 0);
+
+    // 2^d-tree of cells: the coarse ones lie between neighbouring points begin + k * step, children of a cell
+    // are its 2^d halves (axes with a single lattice point are not split) stored one after another
+    struct Refinement {
+        static size_t const MAX_AXES = 16;
+
+        size_t dim {0};
+        // every evaluated point and the value of the function at it
+        std::vector<double> points;
+        std::vector<double> values;
+        // least and greatest corner of every cell, dim coordinates each
+        std::vector<double> lows;
+        std::vector<double> highs;
+        std::vector<size_t> depths;
+        // parent of every cell, SIZE_MAX for coarse ones, and its first child, SIZE_MAX for leaves
+        std::vector<size_t> parents;
+        std::vector<size_t> children;
+    };
+    // fn(point) at the corners of every cell and at the centers of those below maxDepth; a cell is split
+    // when the values there differ by more than threshold; every level is a worklist of cells whose new
+    // points are evaluated by threads (0 means all hardware threads), fn must be safe to call concurrently
+    template <class Fn>
+    ReturnCode refine(IVector const* step, Fn fn, double threshold, size_t maxDepth, Refinement& result, size_t threads = 0) const;
+
+    struct Optimum {
+        std::vector<double> point;
+        double value {0};
+        // boxes taken from the queue, one fn call each
+        size_t evaluations {0};
+        // false if maxBoxes stopped the search before the queue ran out
+        bool proven {false};
+    };
+    // global minimum of fn(point) by branch and bound: boxes are taken in the order of bound(low, high), a lower
+    // bound of fn over the box, fn is evaluated at the center of a box and the box is bisected across its widest axis
+    // unless it is narrower than width along every axis; boxes with bound not below the best value minus tolerance
+    // are pruned; threads (0 means all hardware threads) share the queue, fn and bound must be safe to call concurrently
+    template <class Fn, class Bound>
+    ReturnCode minimize(Fn fn, Bound bound, double tolerance, double width, Optimum& result,
+                        size_t threads = 0, size_t maxBoxes = SIZE_MAX) const;
+    // number of points begin + k * step in the compact, the points an iterator from begin walks through
+    virtual ReturnCode getGridSize(IVector const* step, size_t& count) const = 0;
+    // number of these points along every axis
+    virtual ReturnCode getGridShape(IVector const* step, std::vector<size_t>& counts) const = 0;
+    // all these points one after another in the order of an iterator with the given direction and traversal;
+    // points holds count points, count must not be less than the grid size
+    virtual ReturnCode generateGrid(IVector const* step, std::vector<size_t> const& direction, double* points, size_t count,
+                                    Traversal traversal = Traversal::LEXICOGRAPHIC, size_t blockSize = 8) const = 0;
+    virtual ReturnCode generateGrid(IVector const* step, std::vector<size_t> const& direction, std::vector<double>& points,
+                                    Traversal traversal = Traversal::LEXICOGRAPHIC, size_t blockSize = 8) const = 0;
+    // samples first..first + count - 1 of total ones one after another, every sample depends only on the seed and
+    // its number, so ranges may be generated separately; seed 0 gives the plain Sobol and Halton sequences,
+    // others scramble them; Sobol works in up to 1024 dimensions and 2^32 samples
+    virtual ReturnCode generateSamples(Sampling method, uint64_t seed, size_t total, size_t first, double* points, size_t count) const = 0;
+    virtual ReturnCode generateSamples(Sampling method, uint64_t seed, size_t count, std::vector<double>& points) const = 0;
+
     virtual ICompact* clone()                                         const = 0;
     virtual IVector* getBegin()                                       const = 0;
     virtual IVector* getEnd()                                         const = 0;
     virtual ReturnCode contains(IVector const* vec, bool& result)     const = 0;
+    // mask[k] is 1 if point k of count ones laid out one after another lies in the compact and 0 otherwise
+    virtual ReturnCode containsBatch(double const* points, size_t count, uint8_t* mask) const = 0;
     virtual ReturnCode isSubset(ICompact const* comp, bool& result)   const = 0;
     virtual ReturnCode intersects(ICompact const* comp, bool& result) const = 0;
     virtual size_t getDim()                                           const = 0;
@@ -43,8 +160,15 @@ public:
     virtual ~ICompact() = 0;
 
 private:
+    ReturnCode planChunks(IVector const* step, size_t& threads, size_t& chunkSize, size_t& count, size_t& chunks) const;
+    template <class Body>
+    ReturnCode runChunks(IVector const* step, size_t threads, size_t chunkSize, size_t count, size_t chunks, Body body);
+
     ICompact(ICompact const&)            = delete;
     ICompact& operator=(ICompact const&) = delete;
 };
 
+// Lattice and the bodies of the templates above
+#include "ICompactAlgorithms.h"
+
 #endif /* ICOMPACT_H */
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef ICOMPACTSET_H
+#define ICOMPACTSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "IVector.h"
+#include "ICompact.h"
+
+// region made of any number of boxes of one dimension, possibly overlapping, indexed by an R-tree;
+// boxes are closed, so results of region operations are closed as well and pieces thinner than
+// the tolerance along some axis are dropped
+class DECLSPEC ICompactSet {
+public:
+    static ICompactSet* createCompactSet(size_t dim, double tolerance, ILogger* logger = nullptr);
+    // the tree over all boxes is packed at once by sort-tile-recursive loading
+    static ICompactSet* createCompactSet(std::vector<ICompact const*> const& boxes, double tolerance, ILogger* logger = nullptr);
+    static ICompactSet* _union(ICompactSet const* set1, ICompactSet const* set2, ILogger* logger = nullptr);
+    // boxes touching by a boundary only add nothing
+    static ICompactSet* intersection(ICompactSet const* set1, ICompactSet const* set2, ILogger* logger = nullptr);
+    // points of set1 out of set2, with the common boundary
+    static ICompactSet* difference(ICompactSet const* set1, ICompactSet const* set2, ILogger* logger = nullptr);
+
+    // one box into the tree, nodes on the way are split when they overflow; stored boxes must be at least
+    // tolerance wide along every axis, while boxes given to queries may be flat or points
+    virtual ReturnCode insert(ICompact const* box) = 0;
+    virtual size_t getDim() const = 0;
+    virtual size_t getSize() const = 0;
+    virtual ICompact* getBox(size_t index) const = 0;
+    virtual ICompactSet* clone() const = 0;
+
+    virtual ReturnCode contains(IVector const* vec, bool& result) const = 0;
+    // box lies in the region, even if no single box of it holds the whole box
+    virtual ReturnCode contains(ICompact const* box, bool& result) const = 0;
+    virtual ReturnCode intersects(ICompact const* box, bool& result) const = 0;
+    // mask[k] is 1 if point k of count ones laid out one after another lies in some box and 0 otherwise
+    virtual ReturnCode containsBatch(double const* points, size_t count, uint8_t* mask) const = 0;
+    // numbers of the boxes holding every point: ids[offsets[k]..offsets[k + 1]) for point k in increasing order
+    virtual ReturnCode classify(double const* points, size_t count, std::vector<size_t>& offsets, std::vector<size_t>& ids) const = 0;
+    // numbers of the boxes meeting the given one
+    virtual ReturnCode query(ICompact const* box, std::vector<size_t>& indices) const = 0;
+    // this region lies in the other one
+    virtual ReturnCode isSubset(ICompactSet const* other, bool& result) const = 0;
+    virtual ReturnCode intersects(ICompactSet const* other, bool& result) const = 0;
+
+    ICompactSet() = default;
+    virtual ~ICompactSet() = 0;
+
+private:
+    ICompactSet(ICompactSet const&)            = delete;
+    ICompactSet& operator=(ICompactSet const&) = delete;
+};
+
+#endif /* ICOMPACTSET_H */
@@ -6,6 +6,7 @@
 #include "IVector.h"
 #include "ISet.h"
 #include "ICompact.h"
+#include "ICompactSet.h"
 #include<iostream>
 #include <vector>
 
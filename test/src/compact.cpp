@@ -1,4 +1,7 @@
 #include "../include/test.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #define FILE_NAME "Log_compact.txt"
 
 ReturnCode compact_create_test(ILogger * logger) {
@@ -281,6 +284,936 @@ ReturnCode compact_convex_test(ILogger * logger) {
     return r_code;
 }
 
+ReturnCode compact_bounding_box_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim2 = 2;
+
+    double data1[dim2] = {0, 3};
+    double data2[dim2] = {2, -1};
+    IVector * vec1 = IVector::createVector(dim2, data1, logger);
+    IVector * vec2 = IVector::createVector(dim2, data2, logger);
+    ISet * set = ISet::createSet(logger);
+    set->insert(vec1, IVector::Norm::NORM_2, accuracy);
+    set->insert(vec2, IVector::Norm::NORM_2, accuracy);
+
+    ICompact * box = ICompact::createBoundingBox(set, logger);
+    if (box == nullptr) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    } else {
+        IVector * begin = box->getBegin();
+        IVector * end = box->getEnd();
+        if (begin->getCoord(0) != 0 || begin->getCoord(1) != -1 ||
+            end->getCoord(0) != 2 || end->getCoord(1) != 3) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        delete begin;
+        delete end;
+    }
+
+    ISet * empty_set = ISet::createSet(logger);
+    if (ICompact::createBoundingBox(empty_set, logger) != nullptr) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    delete vec1;
+    delete vec2;
+    delete set;
+    delete empty_set;
+    delete box;
+    return r_code;
+}
+
+ReturnCode compact_iterator_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim2 = 2;
+
+    double data1[dim2] = {0, 0};
+    double data2[dim2] = {1, 0.3};
+    double data3[dim2] = {0.5, 0.1};
+    IVector * vec1 = IVector::createVector(dim2, data1, logger);
+    IVector * vec2 = IVector::createVector(dim2, data2, logger);
+    IVector * step = IVector::createVector(dim2, data3, logger);
+    ICompact * comp = ICompact::createCompact(vec1, vec2, accuracy, logger);
+
+    // coordinates are begin + k * step, second axis goes first
+    ICompact::Iterator * it = comp->begin(step);
+    std::vector<size_t> wrong_direction = {0, 0};
+    std::vector<size_t> direction = {1, 0};
+    if (it == nullptr || it->getDim() != dim2 || it->setDirection(wrong_direction) != ReturnCode::RC_INVALID_PARAMS ||
+        it->setDirection(direction) != ReturnCode::RC_SUCCESS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    } else {
+        double point[dim2];
+        size_t count = 0;
+        do {
+            it->getPoint(point);
+            if (point[0] != (count / 3) * 0.5 || point[1] != (count % 3) * 0.1) {
+                r_code = ReturnCode::RC_UNKNOWN;
+            }
+            count++;
+        } while (it->doStep() == ReturnCode::RC_SUCCESS);
+        // the point after the last one is the end of the compact
+        IVector * last = it->getPoint();
+        if (count != 9 || last->getCoord(0) != 1 || last->getCoord(1) != 0.3 || it->doStep() != ReturnCode::RC_OUT_OF_BOUNDS) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        delete last;
+    }
+    delete it;
+
+    ICompact::Iterator * inverse = comp->end(step);
+    double point[dim2];
+    if (inverse == nullptr || inverse->getPoint(point) != ReturnCode::RC_SUCCESS || point[0] != 1 || point[1] != 0.3 ||
+        inverse->doStep() != ReturnCode::RC_SUCCESS || inverse->getPoint(point) != ReturnCode::RC_SUCCESS ||
+        point[0] != 0.5 || point[1] != 0.3) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    delete inverse;
+
+    // more points along an axis than size_t holds on 32-bit targets are cut, never to zero
+    double data4[dim2] = {1e-10, 0.1};
+    IVector * fine_step = IVector::createVector(dim2, data4, logger);
+    std::vector<size_t> counts;
+    ReturnCode shape_code = comp->getGridShape(fine_step, counts);
+    ICompact::Iterator * fine = comp->begin(fine_step);
+    if ((shape_code != ReturnCode::RC_SUCCESS && shape_code != ReturnCode::RC_OUT_OF_BOUNDS) ||
+        (shape_code == ReturnCode::RC_SUCCESS && (counts[0] < (size_t)INT32_MAX || counts[1] != 3)) ||
+        fine == nullptr || fine->doStep() != ReturnCode::RC_SUCCESS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    delete fine;
+    delete fine_step;
+
+    delete vec1;
+    delete vec2;
+    delete step;
+    delete comp;
+    return r_code;
+}
+
+ReturnCode compact_grid_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim3 = 3;
+
+    double data1[dim3] = {0, -1, 2};
+    double data2[dim3] = {1, 0.3, 2.5};
+    double data3[dim3] = {0.25, 0.1, 1};
+    IVector * vec1 = IVector::createVector(dim3, data1, logger);
+    IVector * vec2 = IVector::createVector(dim3, data2, logger);
+    IVector * step = IVector::createVector(dim3, data3, logger);
+    ICompact * comp = ICompact::createCompact(vec1, vec2, accuracy, logger);
+
+    // the grid holds the points of an iterator in its order
+    std::vector<size_t> direction = {1, 2, 0};
+    std::vector<double> grid(64 * dim3);
+    size_t count = 0;
+    ICompact::Iterator * it = comp->begin(step);
+    if (comp->getGridSize(step, count) != ReturnCode::RC_SUCCESS || count != 5 * 13 * 1 ||
+        comp->generateGrid(step, direction, grid.data(), 64) != ReturnCode::RC_OUT_OF_BOUNDS ||
+        comp->generateGrid(step, direction, grid) != ReturnCode::RC_SUCCESS || grid.size() != count * dim3 ||
+        it->setDirection(direction) != ReturnCode::RC_SUCCESS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    } else {
+        double point[dim3];
+        size_t ind = 0;
+        do {
+            it->getPoint(point);
+            if (ind >= count || !std::equal(point, point + dim3, grid.begin() + ind * dim3)) {
+                r_code = ReturnCode::RC_UNKNOWN;
+            }
+            ind++;
+        } while (it->doStep() == ReturnCode::RC_SUCCESS);
+        if (ind != count) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+    }
+
+    delete it;
+    delete vec1;
+    delete vec2;
+    delete step;
+    delete comp;
+    return r_code;
+}
+
+ReturnCode compact_split_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim3 = 3;
+
+    double data1[dim3] = {0, 0, 0};
+    double data2[dim3] = {2, 3, 1};
+    double data3[dim3] = {1, 0.5, 0.5};
+    IVector * vec1 = IVector::createVector(dim3, data1, logger);
+    IVector * vec2 = IVector::createVector(dim3, data2, logger);
+    IVector * step = IVector::createVector(dim3, data3, logger);
+    ICompact * comp = ICompact::createCompact(vec1, vec2, accuracy, logger);
+
+    std::vector<size_t> direction = {2, 0, 1};
+    std::vector<double> grid;
+    ICompact::Iterator * it = comp->begin(step);
+    if (it->setDirection(direction) != ReturnCode::RC_SUCCESS || comp->generateGrid(step, direction, grid) != ReturnCode::RC_SUCCESS ||
+        it->getCount() != 3 * 7 * 3 || it->seek(it->getCount()) != ReturnCode::RC_OUT_OF_BOUNDS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // random access gives the same points as the grid
+    double point[dim3];
+    size_t positions[3] = {0, 17, 62};
+    for (auto position : positions) {
+        if (it->seek(position) != ReturnCode::RC_SUCCESS || it->getPosition() != position ||
+            it->getPoint(point) != ReturnCode::RC_SUCCESS || !std::equal(point, point + dim3, grid.begin() + position * dim3)) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+    }
+
+    // parts walk the grid one after another
+    std::vector<ICompact::Iterator *> parts;
+    if (it->split(5, parts) != ReturnCode::RC_SUCCESS || parts.size() != 5 || parts[0]->setDirection(direction) == ReturnCode::RC_SUCCESS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    size_t ind = 0;
+    for (auto part : parts) {
+        size_t count = 0;
+        do {
+            part->getPoint(point);
+            if (ind >= it->getCount() || !std::equal(point, point + dim3, grid.begin() + ind * dim3)) {
+                r_code = ReturnCode::RC_UNKNOWN;
+            }
+            ind++;
+            count++;
+        } while (part->doStep() == ReturnCode::RC_SUCCESS);
+        if (count != part->getCount()) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        delete part;
+    }
+    if (ind != it->getCount()) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    delete it;
+    delete vec1;
+    delete vec2;
+    delete step;
+    delete comp;
+    return r_code;
+}
+
+namespace {
+    struct Minimum {
+        double value;
+        double point[2];
+    };
+}
+
+ReturnCode compact_parallel_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim2 = 2;
+
+    double data1[dim2] = {-1, -1};
+    double data2[dim2] = {1, 2};
+    double data3[dim2] = {0.01, 0.02};
+    IVector * vec1 = IVector::createVector(dim2, data1, logger);
+    IVector * vec2 = IVector::createVector(dim2, data2, logger);
+    IVector * step = IVector::createVector(dim2, data3, logger);
+    ICompact * comp = ICompact::createCompact(vec1, vec2, accuracy, logger);
+
+    // argmin of (x - 0.3)^2 + (y - 0.5)^2 and a sum, the same for any number of threads
+    auto fn = [](Minimum & acc, double const * point) {
+        double value = (point[0] - 0.3) * (point[0] - 0.3) + (point[1] - 0.5) * (point[1] - 0.5);
+        if (value < acc.value) {
+            acc.value = value;
+            acc.point[0] = point[0];
+            acc.point[1] = point[1];
+        }
+    };
+    auto combine = [](Minimum & acc, Minimum const & other) {
+        if (other.value < acc.value) {
+            acc = other;
+        }
+    };
+    Minimum init = {INFINITY, {0, 0}};
+    Minimum single, several;
+    double sum1 = 0, sum4 = 0;
+    auto add = [](double & acc, double const * point) {
+        acc += point[0] * point[1];
+    };
+    auto plus = [](double & acc, double const & other) {
+        acc += other;
+    };
+    if (comp->parallelReduce(step, init, fn, combine, single, 1) != ReturnCode::RC_SUCCESS ||
+        comp->parallelReduce(step, init, fn, combine, several, 4, 7) != ReturnCode::RC_SUCCESS ||
+        comp->parallelReduce(step, 0.0, add, plus, sum1, 1, 100) != ReturnCode::RC_SUCCESS ||
+        comp->parallelReduce(step, 0.0, add, plus, sum4, 4, 100) != ReturnCode::RC_SUCCESS ||
+        single.value != several.value || std::fabs(single.point[0] - 0.3) > 1e-9 || std::fabs(single.point[1] - 0.5) > 1e-9 ||
+        sum1 != sum4) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // every point is visited once at its position
+    std::vector<double> grid, visited;
+    std::vector<size_t> direction = {0, 1};
+    comp->generateGrid(step, direction, grid);
+    visited.resize(grid.size());
+    if (comp->parallelForEach(step, [&visited](double const * point, size_t position) {
+            visited[2 * position] = point[0];
+            visited[2 * position + 1] = point[1];
+        }, 3) != ReturnCode::RC_SUCCESS || visited != grid) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    delete vec1;
+    delete vec2;
+    delete step;
+    delete comp;
+    return r_code;
+}
+
+// points of the grid in the given order: all lattice points once, the same as the walk of an iterator,
+// its random access and its parts; neighbours differ by one step along one axis if adjacent
+static bool traversal_check(ICompact * comp, IVector * step, std::vector<size_t> const & direction,
+                            ICompact::Traversal traversal, size_t blockSize, bool adjacent) {
+    size_t dim = step->getDim();
+    std::vector<double> grid;
+    size_t count;
+    if (comp->getGridSize(step, count) != ReturnCode::RC_SUCCESS ||
+        comp->generateGrid(step, direction, grid, traversal, blockSize) != ReturnCode::RC_SUCCESS) {
+        return false;
+    }
+    // lattice points are integer from zero here
+    IVector * end = comp->getEnd();
+    std::vector<size_t> strides(dim, 1);
+    for (size_t i = 1; i < dim; i++) {
+        strides[i] = strides[i - 1] * ((size_t)end->getCoord(i - 1) + 1);
+    }
+    delete end;
+    std::vector<bool> seen(count, false);
+    for (size_t ind = 0; ind < count; ind++) {
+        size_t number = 0;
+        for (size_t i = 0; i < dim; i++) {
+            number += (size_t)grid[ind * dim + i] * strides[i];
+        }
+        if (number >= count || seen[number]) {
+            return false;
+        }
+        seen[number] = true;
+        if (adjacent && ind > 0) {
+            double distance = 0;
+            for (size_t i = 0; i < dim; i++) {
+                distance += std::fabs(grid[ind * dim + i] - grid[(ind - 1) * dim + i]);
+            }
+            if (distance != 1) {
+                return false;
+            }
+        }
+    }
+
+    bool res = true;
+    std::vector<double> point(dim);
+    ICompact::Iterator * it = comp->begin(step);
+    if (it->setDirection(direction) != ReturnCode::RC_SUCCESS || it->setTraversal(traversal, blockSize) != ReturnCode::RC_SUCCESS ||
+        it->getTraversal() != traversal || it->getCount() != count) {
+        res = false;
+    }
+    size_t ind = 0;
+    do {
+        it->getPoint(point.data());
+        if (ind >= count || !std::equal(point.begin(), point.end(), grid.begin() + ind * dim)) {
+            res = false;
+        }
+        ind++;
+    } while (it->doStep() == ReturnCode::RC_SUCCESS);
+    res = res && ind == count;
+    for (size_t position = 0; position < count; position += 7) {
+        if (it->seek(position) != ReturnCode::RC_SUCCESS || it->getPoint(point.data()) != ReturnCode::RC_SUCCESS ||
+            !std::equal(point.begin(), point.end(), grid.begin() + position * dim)) {
+            res = false;
+        }
+    }
+
+    std::vector<ICompact::Iterator *> parts;
+    if (it->split(4, parts) != ReturnCode::RC_SUCCESS || parts[1]->setTraversal(traversal, blockSize) == ReturnCode::RC_SUCCESS) {
+        res = false;
+    }
+    ind = 0;
+    for (auto part : parts) {
+        do {
+            part->getPoint(point.data());
+            if (ind >= count || !std::equal(point.begin(), point.end(), grid.begin() + ind * dim)) {
+                res = false;
+            }
+            ind++;
+        } while (part->doStep() == ReturnCode::RC_SUCCESS);
+        delete part;
+    }
+    delete it;
+    return res && ind == count;
+}
+
+ReturnCode compact_traversal_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim2 = 2, dim3 = 3;
+
+    double data1[dim3] = {0, 0, 0};
+    double data2[dim3] = {4, 2, 3};
+    double data3[dim3] = {1, 1, 1};
+    double data4[dim2] = {7, 7};
+    IVector * vec1 = IVector::createVector(dim3, data1, logger);
+    IVector * vec2 = IVector::createVector(dim3, data2, logger);
+    IVector * step3 = IVector::createVector(dim3, data3, logger);
+    IVector * vec3 = IVector::createVector(dim2, data1, logger);
+    IVector * vec4 = IVector::createVector(dim2, data4, logger);
+    IVector * step2 = IVector::createVector(dim2, data3, logger);
+    ICompact * box = ICompact::createCompact(vec1, vec2, accuracy, logger);
+    ICompact * square = ICompact::createCompact(vec3, vec4, accuracy, logger);
+
+    std::vector<size_t> direction = {1, 2, 0};
+    std::vector<size_t> direction2 = {0, 1};
+    if (!traversal_check(box, step3, direction, ICompact::Traversal::LEXICOGRAPHIC, 8, false) ||
+        !traversal_check(box, step3, direction, ICompact::Traversal::SERPENTINE, 8, true) ||
+        !traversal_check(box, step3, direction, ICompact::Traversal::HILBERT, 8, false) ||
+        !traversal_check(box, step3, direction, ICompact::Traversal::BLOCKED, 2, false) ||
+        !traversal_check(box, step3, direction, ICompact::Traversal::BLOCKED, 3, false) ||
+        !traversal_check(square, step2, direction2, ICompact::Traversal::SERPENTINE, 8, true) ||
+        !traversal_check(square, step2, direction2, ICompact::Traversal::HILBERT, 8, true) ||
+        !traversal_check(square, step2, direction2, ICompact::Traversal::BLOCKED, 4, false)) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // changing the order keeps the current point
+    double point[dim3], other[dim3];
+    ICompact::Iterator * it = box->begin(step3);
+    if (it->seek(23) != ReturnCode::RC_SUCCESS || it->getPoint(point) != ReturnCode::RC_SUCCESS ||
+        it->setTraversal(ICompact::Traversal::HILBERT) != ReturnCode::RC_SUCCESS || it->getPoint(other) != ReturnCode::RC_SUCCESS ||
+        !std::equal(point, point + dim3, other)) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    size_t position = it->getPosition();
+    if (it->seek(0) != ReturnCode::RC_SUCCESS || it->seek(position) != ReturnCode::RC_SUCCESS ||
+        it->getPoint(other) != ReturnCode::RC_SUCCESS || !std::equal(point, point + dim3, other) ||
+        it->setTraversal(ICompact::Traversal::BLOCKED, 0) == ReturnCode::RC_SUCCESS || it->getTraversal() != ICompact::Traversal::HILBERT) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    delete it;
+
+    delete vec1;
+    delete vec2;
+    delete vec3;
+    delete vec4;
+    delete step2;
+    delete step3;
+    delete box;
+    delete square;
+    return r_code;
+}
+
+ReturnCode compact_lattice_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim3 = 3;
+
+    double data1[dim3] = {-1, 0, 2};
+    double data2[dim3] = {1, 3, 2.5};
+    double data3[dim3] = {0.5, 1, 0.25};
+    IVector * vec1 = IVector::createVector(dim3, data1, logger);
+    IVector * vec2 = IVector::createVector(dim3, data2, logger);
+    IVector * step = IVector::createVector(dim3, data3, logger);
+    ICompact * comp = ICompact::createCompact(vec1, vec2, accuracy, logger);
+
+    std::vector<double> grid;
+    size_t count;
+    ICompact::Lattice lattice = comp->lattice(step);
+    if (comp->getGridSize(step, count) != ReturnCode::RC_SUCCESS || comp->generateGrid(step, {0, 1, 2}, grid) != ReturnCode::RC_SUCCESS ||
+        lattice.size() != count || lattice.getDim() != dim3 || std::distance(lattice.begin(), lattice.end()) != (std::ptrdiff_t)count) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // the range walks the points of the grid
+    size_t ind = 0;
+    double point[dim3];
+    for (auto const & p : lattice) {
+        p.copyTo(point);
+        if (p.size() != dim3 || p.position() != ind || ind >= count || !std::equal(point, point + dim3, grid.begin() + ind * dim3) ||
+            p[1] != grid[ind * dim3 + 1]) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        ind++;
+    }
+    if (ind != count) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // standard algorithms and random access
+    auto it = std::find_if(lattice.begin(), lattice.end(), [](ICompact::Lattice::Point const & p) {
+        return p[0] == 0.5 && p[1] == 2 && p[2] == 2.25;
+    });
+    size_t on_plane = std::count_if(lattice.begin(), lattice.end(), [](ICompact::Lattice::Point const & p) {
+        return p[2] == 2.5;
+    });
+    ICompact::Lattice::iterator last = lattice.end() - 1;
+    if (it == lattice.end() || (*it).position() != 3 + 5 * 2 + 5 * 4 * 1 || on_plane != 5 * 4 ||
+        last[0].position() != count - 1 || lattice[7].position() != 7 || last - lattice.begin() != (std::ptrdiff_t)count - 1 ||
+        !(lattice.begin() < last) || std::next(lattice.begin(), 7) != lattice.begin() + 7) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // a wrong step gives an empty range
+    IVector * wrong = IVector::createVector(2, data3, logger);
+    ICompact::Lattice empty = comp->lattice(wrong);
+    if (!empty.empty() || empty.begin() != empty.end()) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    delete wrong;
+    delete vec1;
+    delete vec2;
+    delete step;
+    delete comp;
+    return r_code;
+}
+
+// samples along every axis fall in equal slices of the box as many times each
+static bool sampling_balanced(std::vector<double> const & samples, size_t dim, double const * begin, double const * end, size_t slices) {
+    size_t count = samples.size() / dim;
+    for (size_t j = 0; j < dim; j++) {
+        std::vector<size_t> hits(slices, 0);
+        for (size_t k = 0; k < count; k++) {
+            double value = samples[k * dim + j];
+            if (value < begin[j] || value >= end[j]) {
+                return false;
+            }
+            hits[std::min(slices - 1, (size_t)((value - begin[j]) / (end[j] - begin[j]) * slices))]++;
+        }
+        if (std::count(hits.begin(), hits.end(), count / slices) != (std::ptrdiff_t)slices) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ReturnCode compact_sampling_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim2 = 2, dim5 = 5;
+
+    double data1[dim5] = {-1, 0, 2, -4, 10};
+    double data2[dim5] = {1, 4, 3, 4, 12};
+    IVector * vec1 = IVector::createVector(dim2, data1, logger);
+    IVector * vec2 = IVector::createVector(dim2, data2, logger);
+    IVector * vec3 = IVector::createVector(dim5, data1, logger);
+    IVector * vec4 = IVector::createVector(dim5, data2, logger);
+    ICompact * comp2 = ICompact::createCompact(vec1, vec2, accuracy, logger);
+    ICompact * comp5 = ICompact::createCompact(vec3, vec4, accuracy, logger);
+
+    // the plain sequences start with known points
+    std::vector<double> sobol, halton;
+    double sobol_start[8] = {-1, 0, 0, 2, 0.5, 1, -0.5, 3};
+    double halton_start[8] = {-1, 0, 0, 4.0 / 3, -0.5, 8.0 / 3, 0.5, 4.0 / 9};
+    if (comp2->generateSamples(ICompact::Sampling::SOBOL, 0, 4, sobol) != ReturnCode::RC_SUCCESS ||
+        comp2->generateSamples(ICompact::Sampling::HALTON, 0, 4, halton) != ReturnCode::RC_SUCCESS ||
+        !std::equal(sobol.begin(), sobol.end(), sobol_start)) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    for (size_t k = 0; k < 8; k++) {
+        if (std::fabs(halton[k] - halton_start[k]) > 1e-12) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+    }
+
+    // every method spreads samples evenly, a range generated apart is the same as in the whole
+    const size_t total = 256;
+    ICompact::Sampling methods[4] = {ICompact::Sampling::SOBOL, ICompact::Sampling::HALTON,
+                                     ICompact::Sampling::LATIN_HYPERCUBE, ICompact::Sampling::STRATIFIED};
+    size_t slices[4] = {256, 1, 256, 1};
+    for (size_t m = 0; m < 4; m++) {
+        std::vector<double> samples, other;
+        double part[10 * dim5];
+        if (comp5->generateSamples(methods[m], 7, total, samples) != ReturnCode::RC_SUCCESS ||
+            comp5->generateSamples(methods[m], 8, total, other) != ReturnCode::RC_SUCCESS || samples == other ||
+            comp5->generateSamples(methods[m], 7, total, 100, part, 10) != ReturnCode::RC_SUCCESS ||
+            !std::equal(part, part + 10 * dim5, samples.begin() + 100 * dim5) ||
+            !sampling_balanced(samples, dim5, data1, data2, slices[m])) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+    }
+
+    // stratified samples in two dimensions take one of 16 x 16 cells each
+    std::vector<double> cells;
+    if (comp2->generateSamples(ICompact::Sampling::STRATIFIED, 3, total, cells) != ReturnCode::RC_SUCCESS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    std::vector<bool> taken(total, false);
+    for (size_t k = 0; k < cells.size() / dim2; k++) {
+        size_t cell = (size_t)((cells[k * dim2] + 1) / 2 * 16) + 16 * (size_t)(cells[k * dim2 + 1] / 4 * 16);
+        if (cell >= total || taken[cell]) {
+            r_code = ReturnCode::RC_UNKNOWN;
+            break;
+        }
+        taken[cell] = true;
+    }
+
+    double point[dim5];
+    if (comp2->generateSamples(ICompact::Sampling::HALTON, 0, 4, 3, point, 2) != ReturnCode::RC_OUT_OF_BOUNDS ||
+        comp2->generateSamples(ICompact::Sampling::SOBOL, 0, 4, 0, nullptr, 1) != ReturnCode::RC_NULL_PTR) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    delete vec1;
+    delete vec2;
+    delete vec3;
+    delete vec4;
+    delete comp2;
+    delete comp5;
+    return r_code;
+}
+
+ReturnCode compact_refine_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim3 = 3;
+
+    // the third axis holds a single lattice point and is not split
+    double data1[dim3] = {0, 0, 5};
+    double data2[dim3] = {1, 1, 5.5};
+    double data3[dim3] = {0.5, 0.5, 1};
+    IVector * vec1 = IVector::createVector(dim3, data1, logger);
+    IVector * vec2 = IVector::createVector(dim3, data2, logger);
+    IVector * step = IVector::createVector(dim3, data3, logger);
+    ICompact * comp = ICompact::createCompact(vec1, vec2, accuracy, logger);
+
+    // a smooth function leaves the 2 x 2 coarse cells whole: 9 corners and 4 centers
+    ICompact::Refinement flat;
+    auto plane = [](double const * point) {
+        return point[0] + point[1];
+    };
+    if (comp->refine(step, plane, 2, 5, flat) != ReturnCode::RC_SUCCESS || flat.depths.size() != 4 || flat.values.size() != 13 ||
+        flat.points.size() != 13 * dim3) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // a jump is followed down to the finest cells, far fewer points than the full finest grid of 33 x 33 have
+    const size_t depth = 4;
+    auto jump = [](double const * point) {
+        return point[0] + point[1] > 0.7 ? 1.0 : 0.0;
+    };
+    ICompact::Refinement one, many;
+    if (comp->refine(step, jump, 0.5, depth, one, 1) != ReturnCode::RC_SUCCESS ||
+        comp->refine(step, jump, 0.5, depth, many, 4) != ReturnCode::RC_SUCCESS ||
+        one.points != many.points || one.values != many.values || one.lows != many.lows ||
+        one.values.size() >= 33 * 33 / 2 || one.depths.size() <= 4) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // leaves tile the square, split cells are crossed by the jump, leaves at the finest level are found along it only
+    double area = 0;
+    for (size_t cell = 0; cell < one.depths.size(); cell++) {
+        double const * low = one.lows.data() + cell * dim3;
+        double const * high = one.highs.data() + cell * dim3;
+        bool crossed = low[0] + low[1] <= 0.7 && high[0] + high[1] > 0.7;
+        if (low[2] != 5 || high[2] != 5 || (one.children[cell] != SIZE_MAX && !crossed) ||
+            (one.depths[cell] == depth && !crossed && !(low[0] + low[1] <= 0.7 + 1.0 / 16 && high[0] + high[1] > 0.7 - 1.0 / 16)) ||
+            (one.parents[cell] != SIZE_MAX && one.depths[one.parents[cell]] + 1 != one.depths[cell])) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        if (one.children[cell] == SIZE_MAX) {
+            area += (high[0] - low[0]) * (high[1] - low[1]);
+        }
+    }
+    if (area != 1 || comp->refine(step, jump, -1, depth, one) != ReturnCode::RC_INVALID_PARAMS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    delete vec1;
+    delete vec2;
+    delete step;
+    delete comp;
+    return r_code;
+}
+
+ReturnCode compact_minimize_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const double accuracy = 1e-4;
+    const size_t dim2 = 2;
+
+    double data1[dim2] = {-1, -1};
+    double data2[dim2] = {1, 1};
+    IVector * vec1 = IVector::createVector(dim2, data1, logger);
+    IVector * vec2 = IVector::createVector(dim2, data2, logger);
+    ICompact * comp = ICompact::createCompact(vec1, vec2, accuracy, logger);
+
+    // a paraboloid with the exact minimum over a box as its bound
+    double target[dim2] = {0.3, -0.2};
+    auto paraboloid = [&target](double const * point) {
+        return (point[0] - target[0]) * (point[0] - target[0]) + (point[1] - target[1]) * (point[1] - target[1]);
+    };
+    auto box_bound = [&target, &paraboloid](double const * low, double const * high) {
+        double nearest[dim2];
+        for (size_t i = 0; i < dim2; i++) {
+            nearest[i] = std::max(low[i], std::min(high[i], target[i]));
+        }
+        return paraboloid(nearest);
+    };
+    ICompact::Optimum one, many, cut;
+    if (comp->minimize(paraboloid, box_bound, 1e-9, 1e-6, one, 1) != ReturnCode::RC_SUCCESS ||
+        comp->minimize(paraboloid, box_bound, 1e-9, 1e-6, many, 4) != ReturnCode::RC_SUCCESS ||
+        !one.proven || !many.proven || one.value > 1e-9 || many.value > 1e-9 || one.evaluations > 1000 ||
+        std::fabs(one.point[0] - target[0]) > 1e-4 || std::fabs(one.point[1] - target[1]) > 1e-4) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // a wavy function with a Lipschitz bound, compared with a fine sweep
+    auto wave = [](double const * point) {
+        return std::sin(5 * point[0]) * std::cos(3 * point[1]) + 0.3 * point[0];
+    };
+    auto lipschitz = [&wave](double const * low, double const * high) {
+        double center[dim2] = {(low[0] + high[0]) / 2, (low[1] + high[1]) / 2};
+        return wave(center) - 5.3 * (high[0] - low[0]) / 2 - 3 * (high[1] - low[1]) / 2;
+    };
+    double sweep = INFINITY;
+    for (size_t x = 0; x <= 400; x++) {
+        for (size_t y = 0; y <= 400; y++) {
+            double point[dim2] = {-1 + x / 200.0, -1 + y / 200.0};
+            sweep = std::min(sweep, wave(point));
+        }
+    }
+    if (comp->minimize(wave, lipschitz, 1e-4, 1e-5, one, 4) != ReturnCode::RC_SUCCESS || !one.proven ||
+        one.value > sweep + 1e-4 || one.evaluations >= 401 * 401 ||
+        comp->minimize(wave, lipschitz, 1e-4, 1e-3, cut, 2, 10) != ReturnCode::RC_SUCCESS || cut.proven || cut.evaluations != 10 ||
+        comp->minimize(wave, lipschitz, 1e-4, 0, cut) != ReturnCode::RC_INVALID_PARAMS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    delete vec1;
+    delete vec2;
+    delete comp;
+    return r_code;
+}
+
+// zero tolerance lets boxes be flat or points
+static ICompact * box2(double x1, double y1, double x2, double y2, ILogger * logger, double tolerance = 1e-9) {
+    double low[2] = {x1, y1}, high[2] = {x2, y2};
+    IVector * begin = IVector::createVector(2, low, logger);
+    IVector * end = IVector::createVector(2, high, logger);
+    ICompact * box = ICompact::createCompact(begin, end, tolerance, logger);
+    delete begin;
+    delete end;
+    return box;
+}
+
+ReturnCode compact_set_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const size_t dim2 = 2;
+
+    // cells of a 30 x 30 checkerboard, half of them packed at once and half inserted one by one
+    std::vector<ICompact *> boxes;
+    std::vector<ICompact const *> packed;
+    ICompactSet * board = ICompactSet::createCompactSet(dim2, 0, logger);
+    for (size_t x = 0; x < 30; x++) {
+        for (size_t y = x % 2; y < 30; y += 2) {
+            boxes.push_back(box2(x, y, x + 1, y + 1, logger));
+            if (y % 4 < 2) {
+                packed.push_back(boxes.back());
+            }
+        }
+    }
+    ICompactSet * half = ICompactSet::createCompactSet(packed, 0, logger);
+    for (auto box : boxes) {
+        if (board->insert(box) != ReturnCode::RC_SUCCESS) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+    }
+    if (board->getSize() != 450 || half->getSize() != packed.size()) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // queries agree with the checkerboard
+    double data[dim2];
+    bool result, other;
+    for (size_t k = 0; k < 200; k++) {
+        data[0] = (k * 37 % 300) / 10.0 + 0.05;
+        data[1] = (k * 53 % 300) / 10.0 + 0.05;
+        IVector * point = IVector::createVector(dim2, data, logger);
+        bool black = ((size_t)data[0] + (size_t)data[1]) % 2 == 0;
+        if (board->contains(point, result) != ReturnCode::RC_SUCCESS || result != black ||
+            half->contains(point, other) != ReturnCode::RC_SUCCESS || other != (black && (size_t)data[1] % 4 < 2)) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        delete point;
+    }
+    std::vector<size_t> indices;
+    ICompact * window = box2(10.5, 10.5, 12.5, 11.5, logger);
+    ICompact * inner = box2(4.2, 6.2, 4.8, 6.8, logger);
+    ICompact * white = box2(5.2, 6.2, 5.8, 6.8, logger);
+    if (board->query(window, indices) != ReturnCode::RC_SUCCESS || indices.size() != 3 ||
+        board->contains(window, result) != ReturnCode::RC_SUCCESS || result ||
+        board->contains(inner, result) != ReturnCode::RC_SUCCESS || !result ||
+        board->intersects(white, result) != ReturnCode::RC_SUCCESS || result) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // a box made of two neighbouring ones is covered by them together
+    std::vector<ICompact const *> pair = {box2(0, 0, 2, 1, logger), box2(2, 0, 3, 1, logger)};
+    ICompactSet * strip = ICompactSet::createCompactSet(pair, 0, logger);
+    ICompact * across = box2(1, 0.25, 2.5, 0.75, logger);
+    if (strip->contains(across, result) != ReturnCode::RC_SUCCESS || !result) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // stored boxes are at least tolerance wide, queries may be flat boxes or points
+    ICompactSet * wide = ICompactSet::createCompactSet(pair, 0.01, logger);
+    ICompact * flat = box2(0.5, 0.5, 2.5, 0.5, logger, 0);
+    ICompact * dot = box2(1, 0.5, 1, 0.5, logger, 0);
+    ICompact * outside = box2(4, 0.5, 4, 0.5, logger, 0);
+    std::vector<size_t> dot_indices;
+    bool flat_in, dot_in, dot_meets, outside_meets;
+    if (wide == nullptr || flat == nullptr || dot == nullptr || outside == nullptr ||
+        wide->insert(flat) != ReturnCode::RC_INVALID_PARAMS || wide->getSize() != 2 ||
+        wide->contains(flat, flat_in) != ReturnCode::RC_SUCCESS || !flat_in ||
+        wide->contains(dot, dot_in) != ReturnCode::RC_SUCCESS || !dot_in ||
+        wide->intersects(dot, dot_meets) != ReturnCode::RC_SUCCESS || !dot_meets ||
+        wide->intersects(outside, outside_meets) != ReturnCode::RC_SUCCESS || outside_meets ||
+        wide->query(dot, dot_indices) != ReturnCode::RC_SUCCESS || dot_indices != std::vector<size_t>{0}) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    std::vector<ICompact const *> flat_boxes = {pair[0], flat};
+    ICompactSet * rejected = ICompactSet::createCompactSet(flat_boxes, 0.01, logger);
+    if (rejected != nullptr) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    delete wide;
+    delete flat;
+    delete dot;
+    delete outside;
+
+    // region operations
+    ICompactSet * both = ICompactSet::_union(half, strip, logger);
+    ICompactSet * common = ICompactSet::intersection(board, strip, logger);
+    ICompactSet * rest = ICompactSet::difference(strip, board, logger);
+    ICompactSet * empty = ICompactSet::difference(half, board, logger);
+    if (both == nullptr || common == nullptr || rest == nullptr || empty == nullptr) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    } else {
+        bool half_in_board, board_in_half, strip_in_both, common_in_strip, rest_meets_board, rest_meets_strip;
+        half->isSubset(board, half_in_board);
+        board->isSubset(half, board_in_half);
+        strip->isSubset(both, strip_in_both);
+        common->isSubset(strip, common_in_strip);
+        rest->intersects(board, rest_meets_board);
+        rest->intersects(strip, rest_meets_strip);
+        // common holds the black cells (0, 0) and (2, 0), rest the white cell (1, 0) with the boundary
+        ICompact * white_cell = box2(1, 0, 2, 1, logger);
+        bool rest_holds_white, common_holds_white;
+        rest->contains(white_cell, rest_holds_white);
+        common->contains(white_cell, common_holds_white);
+        if (!half_in_board || board_in_half || !strip_in_both || !common_in_strip || common->getSize() != 2 ||
+            !rest_meets_board || !rest_meets_strip || !rest_holds_white || common_holds_white || rest->getSize() != 1 ||
+            empty->getSize() != 0 || both->getSize() != half->getSize() + 2) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        ICompact * piece = rest->getBox(0);
+        IVector * begin = piece == nullptr ? nullptr : piece->getBegin();
+        if (begin == nullptr || begin->getCoord(0) != 1 || begin->getCoord(1) != 0) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        delete begin;
+        delete piece;
+        delete white_cell;
+    }
+
+    for (auto box : boxes) {
+        delete box;
+    }
+    for (auto box : pair) {
+        delete box;
+    }
+    delete window;
+    delete inner;
+    delete white;
+    delete across;
+    delete board;
+    delete half;
+    delete strip;
+    delete both;
+    delete common;
+    delete rest;
+    delete empty;
+    return r_code;
+}
+
+ReturnCode compact_classify_test(ILogger * logger) {
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+    const size_t dim2 = 2;
+
+    // overlapping boxes along a diagonal, points on a grid that also hits their boundaries
+    std::vector<ICompact const *> boxes;
+    for (size_t k = 0; k < 40; k++) {
+        boxes.push_back(box2(k * 0.5, k * 0.25, k * 0.5 + 2, k * 0.25 + 1.5, logger));
+    }
+    std::vector<double> points;
+    for (size_t x = 0; x <= 90; x++) {
+        for (size_t y = 0; y <= 50; y++) {
+            points.push_back(x * 0.25 - 0.5);
+            points.push_back(y * 0.25 - 0.5);
+        }
+    }
+    points.push_back(NAN);
+    points.push_back(1);
+    size_t count = points.size() / dim2;
+
+    std::vector<uint8_t> mask(count);
+    std::vector<size_t> offsets, ids, set_offsets, set_ids;
+    ICompactSet * set = ICompactSet::createCompactSet(boxes, 0, logger);
+    if (ICompact::classify(boxes, points.data(), count, offsets, ids, logger) != ReturnCode::RC_SUCCESS ||
+        set->classify(points.data(), count, set_offsets, set_ids) != ReturnCode::RC_SUCCESS ||
+        offsets != set_offsets || ids != set_ids || offsets.size() != count + 1 || offsets[count] == 0) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // the batch answers and the box numbers agree with contains point by point
+    std::vector<size_t> expected;
+    for (size_t b = 0; b < boxes.size() && r_code == ReturnCode::RC_SUCCESS; b++) {
+        if (boxes[b]->containsBatch(points.data(), count, mask.data()) != ReturnCode::RC_SUCCESS) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        for (size_t k = 0; k < count; k++) {
+            // vectors with NaN are not created, such points lie nowhere
+            IVector * point = IVector::createVector(dim2, points.data() + k * dim2, logger);
+            bool result = false;
+            if (point != nullptr) {
+                boxes[b]->contains(point, result);
+            }
+            bool listed = std::binary_search(ids.begin() + offsets[k], ids.begin() + offsets[k + 1], b);
+            if (result != (mask[k] == 1) || result != listed) {
+                r_code = ReturnCode::RC_UNKNOWN;
+            }
+            delete point;
+        }
+    }
+    if (set->containsBatch(points.data(), count, mask.data()) != ReturnCode::RC_SUCCESS) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+    for (size_t k = 0; k < count; k++) {
+        if ((mask[k] == 1) != (offsets[k + 1] > offsets[k])) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+    }
+    if (boxes[0]->containsBatch(nullptr, 1, mask.data()) != ReturnCode::RC_NULL_PTR) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    for (auto box : boxes) {
+        delete box;
+    }
+    delete set;
+    return r_code;
+}
+
 void compact_testing_run() {
     int client = 3;
     ILogger * logger = ILogger::createLogger(&client);
@@ -306,6 +1239,54 @@ void compact_testing_run() {
         flag = 1;
         std::cout << "compact convex test failed" << std::endl;
     }
+    if (compact_bounding_box_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact bounding box test failed" << std::endl;
+    }
+    if (compact_iterator_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact iterator test failed" << std::endl;
+    }
+    if (compact_grid_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact grid test failed" << std::endl;
+    }
+    if (compact_split_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact split test failed" << std::endl;
+    }
+    if (compact_parallel_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact parallel test failed" << std::endl;
+    }
+    if (compact_traversal_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact traversal test failed" << std::endl;
+    }
+    if (compact_lattice_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact lattice test failed" << std::endl;
+    }
+    if (compact_sampling_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact sampling test failed" << std::endl;
+    }
+    if (compact_refine_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact refine test failed" << std::endl;
+    }
+    if (compact_minimize_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact minimize test failed" << std::endl;
+    }
+    if (compact_set_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact set test failed" << std::endl;
+    }
+    if (compact_classify_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "compact classify test failed" << std::endl;
+    }
     if (flag == 0) {
         std::cout << "ICompact testing passed successfully" << std::endl;
     } else {
@@ -1,4 +1,9 @@
 #include "../include/test.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
 #define FILE_NAME "Log_set.txt"
 
 void getParams(std::vector<IVector *> & vec_s, double & accuracy, IVector::Norm & norm, ILogger * logger) {
@@ -419,6 +424,1084 @@ ReturnCode _clone_test(ILogger * logger) {
     return ReturnCode::RC_SUCCESS;
 }
 
+ReturnCode _approximate_index_test(ILogger * logger) {
+    const size_t dim = 64, count = 200;
+    const double accuracy = 0.5;
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    std::vector<IVector *> vecs, near_vecs;
+    double data[dim];
+    unsigned state = 7;
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = 0; j < dim; j++) {
+            state = state * 1103515245 + 12345;
+            data[j] = (state >> 8) % 10000 / 100.0;
+        }
+        vecs.push_back(IVector::createVector(dim, data, logger));
+        data[0] += 0.01;
+        near_vecs.push_back(IVector::createVector(dim, data, logger));
+    }
+
+    ISet * set = ISet::createSet(logger);
+    if (set->setApproximateIndex(norm, accuracy, 1.5) == ReturnCode::RC_SUCCESS ||
+        set->setApproximateIndex(norm, accuracy, 0.99) != ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    for (auto vec : vecs) {
+        set->insert(vec, norm, accuracy);
+    }
+    if (set->getSize() != count) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    size_t ind, found = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (set->find(vecs[i], norm, accuracy, ind) != ReturnCode::RC_SUCCESS || ind != i) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        if (set->find(near_vecs[i], norm, accuracy, ind) == ReturnCode::RC_SUCCESS && ind == i) {
+            found++;
+        }
+    }
+    if (found < count * 9 / 10) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    if (set->erase(vecs[0], norm, accuracy) != ReturnCode::RC_SUCCESS ||
+        set->find(vecs[1], norm, accuracy, ind) != ReturnCode::RC_SUCCESS || ind != 0 ||
+        set->find(vecs[0], norm, accuracy, ind) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete set;
+    clear_vecs(vecs);
+    clear_vecs(near_vecs);
+    return ReturnCode::RC_SUCCESS;
+}
+
+
+ReturnCode _snapshot_test(ILogger * logger) {
+    const char * file_name = "set_snapshot.bin";
+    std::vector<IVector *> vec_s;
+    IVector::Norm norm;
+    double accuracy;
+    size_t ind;
+
+    getParams(vec_s, accuracy, norm, logger);
+    ISet * set = ISet::createSet(logger);
+    set->setApproximateIndex(norm, accuracy, 0.9);
+    set->insert(vec_s[0], norm, accuracy);
+    set->insert(vec_s[2], norm, accuracy);
+    if (set->save(file_name) != ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    ISet * mapped = ISet::openMapped(file_name, logger);
+    if (mapped == nullptr || mapped->getSize() != 2 || mapped->getDim() != set->getDim()) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    if (mapped->find(vec_s[1], norm, accuracy, ind) != ReturnCode::RC_SUCCESS || ind != 0 ||
+        mapped->find(vec_s[2], norm, accuracy, ind) != ReturnCode::RC_SUCCESS || ind != 1) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    IVector * vec = nullptr;
+    bool equal = false;
+    if (mapped->get(vec, 1) != ReturnCode::RC_SUCCESS ||
+        IVector::equals(vec, vec_s[2], norm, accuracy, equal, logger) != ReturnCode::RC_SUCCESS || !equal) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete vec;
+
+    mapped->erase((size_t)0);
+    if (mapped->getSize() != 1 || set->getSize() != 2 ||
+        mapped->find(vec_s[2], norm, accuracy, ind) != ReturnCode::RC_SUCCESS || ind != 0) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    if (ISet::openMapped("no_such_snapshot.bin", logger) != nullptr) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete mapped;
+    delete set;
+    std::remove(file_name);
+    clear_vecs(vec_s);
+    return ReturnCode::RC_SUCCESS;
+}
+
+// whole file as bytes, the test overwrites parts of it and writes it back
+static std::vector<char> read_file(const char * file_name) {
+    std::vector<char> bytes;
+    FILE * file = fopen(file_name, "rb");
+    if (file != nullptr) {
+        for (int c = fgetc(file); c != EOF; c = fgetc(file)) {
+            bytes.push_back((char)c);
+        }
+        fclose(file);
+    }
+    return bytes;
+}
+
+static void write_file(const char * file_name, std::vector<char> const & bytes, size_t size) {
+    FILE * file = fopen(file_name, "wb");
+    if (file != nullptr) {
+        fwrite(bytes.data(), 1, size, file);
+        fclose(file);
+    }
+}
+
+ReturnCode _corrupted_snapshot_test(ILogger * logger) {
+    const char * file_name = "set_corrupted.bin";
+    std::vector<IVector *> vec_s;
+    IVector::Norm norm;
+    double accuracy;
+    ReturnCode r_code = ReturnCode::RC_SUCCESS;
+
+    getParams(vec_s, accuracy, norm, logger);
+    // an empty set is saved as the header alone
+    ISet * set = ISet::createSet(logger);
+    set->save(file_name);
+    size_t header_size = read_file(file_name).size();
+
+    size_t dim = vec_s[0]->getDim();
+    set->setApproximateIndex(IVector::Norm::NORM_INF, accuracy, 0.9);
+    set->insert(vec_s[0], IVector::Norm::NORM_INF, accuracy);
+    set->insert(vec_s[2], IVector::Norm::NORM_INF, accuracy);
+    set->save(file_name);
+    std::vector<char> bytes = read_file(file_name);
+    size_t axes_offset = header_size + set->getSize() * dim * sizeof(double);
+    if (header_size == 0 || bytes.size() <= axes_offset + sizeof(uint64_t)) {
+        r_code = ReturnCode::RC_UNKNOWN;
+    }
+
+    // the first hash function of the NORM_INF index samples an axis past the point
+    std::vector<char> corrupted(bytes);
+    if (r_code == ReturnCode::RC_SUCCESS) {
+        uint64_t axis = dim;
+        std::copy((char const *)&axis, (char const *)&axis + sizeof(axis), corrupted.begin() + axes_offset);
+        write_file(file_name, corrupted, corrupted.size());
+        if (ISet::openMapped(file_name, logger) != nullptr) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+    }
+    // truncated file
+    if (r_code == ReturnCode::RC_SUCCESS) {
+        write_file(file_name, bytes, bytes.size() - 1);
+        if (ISet::openMapped(file_name, logger) != nullptr) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+    }
+    // the intact file still opens and finds its points
+    if (r_code == ReturnCode::RC_SUCCESS) {
+        write_file(file_name, bytes, bytes.size());
+        ISet * mapped = ISet::openMapped(file_name, logger);
+        size_t ind;
+        if (mapped == nullptr || mapped->find(vec_s[2], IVector::Norm::NORM_INF, accuracy, ind) != ReturnCode::RC_SUCCESS || ind != 1) {
+            r_code = ReturnCode::RC_UNKNOWN;
+        }
+        delete mapped;
+    }
+
+    delete set;
+    std::remove(file_name);
+    clear_vecs(vec_s);
+    return r_code;
+}
+
+ReturnCode _bounds_test(ILogger * logger) {
+    double accuracy = 1e-5;
+    IVector::Norm norm = IVector::Norm::NORM_1;
+    const size_t dim = 2;
+    double data1[dim] = {1, 5};
+    double data2[dim] = {3, -1};
+    double data3[dim] = {2, 2};
+    double data4[dim] = {10, 0};
+    std::vector<IVector *> vecs;
+    vecs.push_back(IVector::createVector(dim, data1, logger));
+    vecs.push_back(IVector::createVector(dim, data2, logger));
+    vecs.push_back(IVector::createVector(dim, data3, logger));
+    IVector * far_vec = IVector::createVector(dim, data4, logger);
+
+    ISet * set = ISet::createSet(logger);
+    IVector * min = nullptr;
+    IVector * max = nullptr;
+    IVector * centroid = nullptr;
+    if (set->getBounds(min, max) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    for (auto vec : vecs) {
+        set->insert(vec, norm, accuracy);
+    }
+    if (set->getBounds(min, max) != ReturnCode::RC_SUCCESS || set->getCentroid(centroid) != ReturnCode::RC_SUCCESS ||
+        min->getCoord(0) != 1 || min->getCoord(1) != -1 || max->getCoord(0) != 3 || max->getCoord(1) != 5 ||
+        centroid->getCoord(0) != 2 || centroid->getCoord(1) != 2) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete min;
+    delete max;
+    delete centroid;
+
+    size_t ind;
+    if (set->find(far_vec, norm, accuracy, ind) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    set->erase(vecs[1], norm, accuracy);
+    if (set->getBounds(min, max) != ReturnCode::RC_SUCCESS || set->getCentroid(centroid) != ReturnCode::RC_SUCCESS ||
+        min->getCoord(1) != 2 || max->getCoord(0) != 2 || centroid->getCoord(0) != 1.5 || centroid->getCoord(1) != 3.5) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete min;
+    delete max;
+    delete centroid;
+
+    delete set;
+    delete far_vec;
+    clear_vecs(vecs);
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _query_box_test(ILogger * logger) {
+    double accuracy = 1e-5;
+    IVector::Norm norm = IVector::Norm::NORM_INF;
+    const size_t dim = 2;
+    ISet * set = ISet::createSet(logger);
+    for (size_t i = 0; i < 10; i++) {
+        for (size_t j = 0; j < 10; j++) {
+            double data[dim] = {(double)i, (double)j};
+            IVector * vec = IVector::createVector(dim, data, logger);
+            set->insert(vec, norm, accuracy);
+            delete vec;
+        }
+    }
+
+    double data_begin[dim] = {2, 3};
+    double data_end[dim] = {4, 3.5};
+    IVector * begin = IVector::createVector(dim, data_begin, logger);
+    IVector * end = IVector::createVector(dim, data_end, logger);
+    ICompact * box = ICompact::createCompact(begin, end, accuracy, logger);
+
+    std::vector<size_t> indices;
+    if (set->queryBox(box, indices) != ReturnCode::RC_SUCCESS || indices.size() != 3) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    for (auto ind : indices) {
+        IVector * vec = nullptr;
+        set->get(vec, ind);
+        if (vec->getCoord(1) != 3 || vec->getCoord(0) < 2 || vec->getCoord(0) > 4) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        delete vec;
+    }
+    if (set->queryBox(nullptr, indices) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete box;
+    delete begin;
+    delete end;
+    delete set;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _find_batch_test(ILogger * logger) {
+    const size_t dim = 3, size = 200, count = 100;
+    const double accuracy = 0.05;
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    ISet * set = ISet::createSet(logger);
+    std::vector<double> queries;
+    unsigned state = 5;
+    for (size_t i = 0; i < size; i++) {
+        double data[dim];
+        for (size_t j = 0; j < dim; j++) {
+            state = state * 1103515245 + 12345;
+            data[j] = (state >> 8) % 1000 / 100.0;
+        }
+        IVector * vec = IVector::createVector(dim, data, logger);
+        set->insert(vec, norm, accuracy);
+        delete vec;
+        if (i % 2 == 0 && queries.size() < count * dim) {
+            // every other query is a shifted element
+            data[1] += i % 4 == 0 ? 0.01 : 1.0;
+            queries.insert(queries.end(), data, data + dim);
+        }
+    }
+    while (queries.size() < count * dim) {
+        queries.push_back(20.0);
+    }
+
+    std::vector<size_t> indices(count);
+    bool found[count];
+    if (set->findBatch(queries.data(), count, norm, accuracy, indices.data(), found) != ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    size_t hits = 0;
+    for (size_t q = 0; q < count; q++) {
+        IVector * vec = IVector::createVector(dim, queries.data() + q * dim, logger);
+        size_t ind;
+        bool single_found = set->find(vec, norm, accuracy, ind) == ReturnCode::RC_SUCCESS;
+        delete vec;
+        if (single_found != found[q] || (found[q] && ind != indices[q])) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        hits += found[q] ? 1 : 0;
+    }
+    if (hits < count / 4 || hits == count) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    if (set->findBatch(nullptr, count, norm, accuracy, indices.data(), found) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete set;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _storage_order_test(ILogger * logger) {
+    double accuracy = 0.1;
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    const size_t dim = 2;
+    ISet * set = ISet::createSet(logger);
+    if (set->setStorageOrder(ISet::StorageOrder::MORTON, 0.0) == ReturnCode::RC_SUCCESS ||
+        set->setStorageOrder(ISet::StorageOrder::MORTON, 1.0) != ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    // inserted backwards, stored by Morton key of the unit cells
+    double data[4][dim] = {{1.5, 1.5}, {1.5, 0.5}, {0.5, 1.5}, {0.5, 0.5}};
+    for (size_t i = 0; i < 4; i++) {
+        IVector * vec = IVector::createVector(dim, data[i], logger);
+        set->insert(vec, norm, accuracy);
+        delete vec;
+    }
+    for (size_t ind = 0; ind < 4; ind++) {
+        IVector * vec = nullptr;
+        set->get(vec, ind);
+        if (vec->getCoord(0) != data[3 - ind][0] || vec->getCoord(1) != data[3 - ind][1]) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        delete vec;
+    }
+    delete set;
+
+    ISet * set1 = ISet::createSet(logger);
+    ISet * set2 = ISet::createSet(logger);
+    ISet * plain1 = ISet::createSet(logger);
+    ISet * plain2 = ISet::createSet(logger);
+    set1->setStorageOrder(ISet::StorageOrder::HILBERT, 0.5);
+    set2->setStorageOrder(ISet::StorageOrder::HILBERT, 0.5);
+    unsigned state = 11;
+    for (size_t i = 0; i < 300; i++) {
+        double coords[dim];
+        for (size_t j = 0; j < dim; j++) {
+            state = state * 1103515245 + 12345;
+            coords[j] = (state >> 8) % 200 / 10.0 - 10.0;
+        }
+        IVector * vec = IVector::createVector(dim, coords, logger);
+        (i % 2 == 0 ? set1 : set2)->insert(vec, norm, accuracy);
+        (i % 2 == 0 ? plain1 : plain2)->insert(vec, norm, accuracy);
+        delete vec;
+    }
+    // every element is found at its own index both by cell lookup and by the full scan
+    for (size_t ind = 0; ind < set1->getSize(); ind++) {
+        IVector * vec = nullptr;
+        size_t near_ind, far_ind;
+        set1->get(vec, ind);
+        if (set1->find(vec, norm, accuracy, near_ind) != ReturnCode::RC_SUCCESS || near_ind != ind ||
+            set1->find(vec, norm, 100.0, far_ind) != ReturnCode::RC_SUCCESS) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        delete vec;
+    }
+
+    ISet * ordered_union = ISet::_union(set1, set2, norm, accuracy, logger);
+    ISet * plain_union = ISet::_union(plain1, plain2, norm, accuracy, logger);
+    ISet * ordered_inter = ISet::intersection(set1, set2, norm, accuracy, logger);
+    ISet * plain_inter = ISet::intersection(plain1, plain2, norm, accuracy, logger);
+    if (ordered_union->getSize() != plain_union->getSize() || ordered_inter->getSize() != plain_inter->getSize() ||
+        ordered_union->getStorageOrder() != ISet::StorageOrder::HILBERT) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    for (size_t ind = 0; ind < plain_union->getSize(); ind++) {
+        IVector * vec = nullptr;
+        size_t found_ind;
+        plain_union->get(vec, ind);
+        if (ordered_union->find(vec, norm, accuracy, found_ind) != ReturnCode::RC_SUCCESS) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        delete vec;
+    }
+
+    size_t size = set1->getSize();
+    set1->erase(size / 2);
+    set1->setStorageOrder(ISet::StorageOrder::INSERTION);
+    if (set1->getSize() != size - 1 || set1->getStorageOrder() != ISet::StorageOrder::INSERTION) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete ordered_union;
+    delete plain_union;
+    delete ordered_inter;
+    delete plain_inter;
+    delete set1;
+    delete set2;
+    delete plain1;
+    delete plain2;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _cluster_test(ILogger * logger) {
+    double accuracy = 0.3;
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    const size_t dim = 2, chains = 5, length = 20;
+    ISet * set = ISet::createSet(logger);
+    // chains of points 0.2 apart: insert keeps about every other point, clustering links each chain as a whole
+    for (size_t k = 0; k < length; k++) {
+        for (size_t c = 0; c < chains; c++) {
+            double data[dim] = {10.0 * c + 0.2 * k, 0.5 * c};
+            IVector * vec = IVector::createVector(dim, data, logger);
+            set->insert(vec, norm, 0.0);
+            delete vec;
+        }
+    }
+
+    std::vector<size_t> labels, parallel_labels;
+    size_t count = 0, parallel_count = 0;
+    if (ISet::cluster(set, norm, accuracy, labels, count) != ReturnCode::RC_SUCCESS || count != chains ||
+        ISet::cluster(set, norm, accuracy, parallel_labels, parallel_count, 4) != ReturnCode::RC_SUCCESS ||
+        parallel_count != count || parallel_labels != labels) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    for (size_t ind = 0; ind < set->getSize(); ind++) {
+        if (labels[ind] != ind % chains) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+    }
+    if (ISet::cluster(set, norm, 0.1, labels, count) != ReturnCode::RC_SUCCESS || count != set->getSize()) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    std::vector<double> centroids, representatives;
+    if (ISet::clusterSummary(set, norm, accuracy, ISet::ClusterSummary::CENTROIDS, centroids, 2, logger) != ReturnCode::RC_SUCCESS ||
+        ISet::clusterSummary(set, norm, accuracy, ISet::ClusterSummary::REPRESENTATIVES, representatives, 1, logger) != ReturnCode::RC_SUCCESS ||
+        centroids.size() != chains * dim || representatives.size() != chains * dim) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    if (std::fabs(centroids[dim] - 11.9) > 1e-9 || centroids[dim + 1] != 0.5) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    // a representative is an element of its cluster
+    size_t ind;
+    IVector * representative = IVector::createVector(dim, &representatives[dim], logger);
+    if (set->find(representative, norm, 0.0, ind) != ReturnCode::RC_SUCCESS || ind % chains != 1) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete representative;
+    if (ISet::cluster(nullptr, norm, accuracy, labels, count) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete set;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode collectPairs(void * context, size_t const * pairs, size_t count) {
+    std::vector<size_t> * result = (std::vector<size_t> *)context;
+    result->insert(result->end(), pairs, pairs + 2 * count);
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _self_join_test(ILogger * logger) {
+    // coordinates are multiples of 0.001, so no distance is close to the tolerance
+    double accuracy = 0.5005;
+    IVector::Norm norm = IVector::Norm::NORM_1;
+    // low dimension is swept, high dimension is compared by tiles
+    size_t const dims[2] = {2, 12};
+    for (auto dim : dims) {
+        const size_t size = 150;
+        std::vector<double> points(size * dim);
+        unsigned state = 3;
+        for (auto & coord : points) {
+            state = state * 1103515245 + 12345;
+            coord = (state >> 8) % 100 / (dim == 2 ? 10.0 : 1000.0);
+        }
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < size; i++) {
+            for (size_t j = i + 1; j < size; j++) {
+                double dist = 0;
+                for (size_t k = 0; k < dim; k++) {
+                    dist += std::fabs(points[i * dim + k] - points[j * dim + k]);
+                }
+                if (dist < accuracy) {
+                    expected.push_back(i * size + j);
+                }
+            }
+        }
+
+        std::vector<size_t> pairs;
+        size_t pair_count = 0;
+        if (ISet::selfJoin(points.data(), size, dim, norm, accuracy, collectPairs, &pairs, pair_count, logger) != ReturnCode::RC_SUCCESS ||
+            pair_count != expected.size() || expected.empty()) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        std::vector<size_t> found;
+        for (size_t p = 0; p < pair_count; p++) {
+            if (pairs[2 * p] >= pairs[2 * p + 1]) {
+                return ReturnCode::RC_UNKNOWN;
+            }
+            found.push_back(pairs[2 * p] * size + pairs[2 * p + 1]);
+        }
+        std::sort(found.begin(), found.end());
+        if (found != expected) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+    }
+
+    const size_t dim = 2;
+    ISet * set1 = ISet::createSet(logger);
+    ISet * set2 = ISet::createSet(logger);
+    for (size_t i = 0; i < 10; i++) {
+        double data1[dim] = {(double)i, 0};
+        double data2[dim] = {i + 0.2, 0};
+        IVector * vec1 = IVector::createVector(dim, data1, logger);
+        IVector * vec2 = IVector::createVector(dim, data2, logger);
+        set1->insert(vec1, norm, 0.0);
+        set2->insert(vec2, norm, 0.0);
+        delete vec1;
+        delete vec2;
+    }
+    std::vector<size_t> pairs;
+    size_t pair_count = 0;
+    if (ISet::join(set1, set2, norm, accuracy, collectPairs, &pairs, pair_count, logger) != ReturnCode::RC_SUCCESS || pair_count != 10) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    for (size_t p = 0; p < pair_count; p++) {
+        if (pairs[2 * p] != pairs[2 * p + 1]) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+    }
+    if (ISet::selfJoin(set1, norm, 1.5, pairs, logger) != ReturnCode::RC_SUCCESS || pairs.size() != 2 * 9) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete set1;
+    delete set2;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _bloom_filter_test(ILogger * logger) {
+    double accuracy = 0.05;
+    IVector::Norm norm = IVector::Norm::NORM_INF;
+    const size_t dim = 3;
+    ISet * set = ISet::createSet(logger);
+    size_t memory;
+    double rate;
+    if (set->getBloomFilterStats(memory, rate) == ReturnCode::RC_SUCCESS ||
+        set->setBloomFilter(accuracy, 0) == ReturnCode::RC_SUCCESS ||
+        set->setBloomFilter(accuracy, 16, 0.01) != ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    // the filter grows past its capacity and is kept in step with erase
+    std::vector<double> points;
+    for (size_t i = 0; i < 100; i++) {
+        double data[dim] = {0.3 * i, 0.7 * i, 1.1 * i};
+        IVector * vec = IVector::createVector(dim, data, logger);
+        set->insert(vec, norm, accuracy);
+        delete vec;
+        points.insert(points.end(), data, data + dim);
+    }
+    set->erase(50);
+    for (size_t i = 0; i < 100; i++) {
+        IVector * vec = IVector::createVector(dim, points.data() + i * dim, logger);
+        size_t ind;
+        bool found = set->find(vec, norm, accuracy, ind) == ReturnCode::RC_SUCCESS;
+        delete vec;
+        if (found != (i != 50)) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+    }
+    if (set->getBloomFilterStats(memory, rate) != ReturnCode::RC_SUCCESS || memory == 0 || rate <= 0 || rate > 0.05) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    set->resetBloomFilter();
+    if (set->getBloomFilterStats(memory, rate) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    // points differ along the last axis only, the rate covers every cell a query touches
+    const size_t wide_dim = 8, count = 200;
+    ISet * wide = ISet::createSet(logger);
+    for (size_t i = 0; i < count; i++) {
+        double data[wide_dim] = {};
+        data[wide_dim - 1] = 0.5 * i;
+        IVector * vec = IVector::createVector(wide_dim, data, logger);
+        wide->insert(vec, norm, accuracy);
+        delete vec;
+    }
+    if (wide->setBloomFilter(accuracy, count, 0.01) != ReturnCode::RC_SUCCESS ||
+        wide->getBloomFilterStats(memory, rate) != ReturnCode::RC_SUCCESS || rate > 0.02) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    for (size_t i = 0; i < count; i++) {
+        double data[wide_dim] = {};
+        data[wide_dim - 1] = 0.5 * i + 0.04;
+        IVector * near = IVector::createVector(wide_dim, data, logger);
+        data[wide_dim - 1] = 0.5 * i + 0.25;
+        IVector * far = IVector::createVector(wide_dim, data, logger);
+        size_t ind;
+        bool found_near = wide->find(near, norm, accuracy, ind) == ReturnCode::RC_SUCCESS && ind == i;
+        bool found_far = wide->find(far, norm, accuracy, ind) == ReturnCode::RC_SUCCESS;
+        delete near;
+        delete far;
+        if (!found_near || found_far) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+    }
+
+    delete wide;
+    delete set;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _exact_match_test(ILogger * logger) {
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    const size_t dim = 3;
+    ISet * set = ISet::createSet(logger);
+    set->setStorageOrder(ISet::StorageOrder::MORTON, 0.5);
+    for (size_t i = 0; i < 200; i++) {
+        double data[dim] = {(double)(i % 50), 0.5 * (i % 50), -0.0};
+        IVector * vec = IVector::createVector(dim, data, logger);
+        set->insert(vec, norm, 0.0);
+        delete vec;
+    }
+    if (set->getSize() != 50) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    // zero tolerance is exact equality: -0.0 equals 0.0, the next double does not
+    double data[dim] = {7, 3.5, 0.0};
+    IVector * vec = IVector::createVector(dim, data, logger);
+    size_t ind;
+    IVector * stored = nullptr;
+    if (set->find(vec, norm, 0.0, ind) != ReturnCode::RC_SUCCESS || set->get(stored, ind) != ReturnCode::RC_SUCCESS ||
+        stored->getCoord(0) != 7 || stored->getCoord(1) != 3.5) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete stored;
+    delete vec;
+    data[1] = std::nextafter(3.5, 4.0);
+    vec = IVector::createVector(dim, data, logger);
+    if (set->find(vec, norm, 0.0, ind) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    set->insert(vec, norm, 0.0);
+    delete vec;
+    if (set->getSize() != 51) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    // indices stay valid after erasing and inserting in the middle of the ordered storage
+    set->erase((size_t)10);
+    for (size_t i = 0; i < 50; i++) {
+        double cur[dim] = {(double)i, 0.5 * i, 0.0};
+        vec = IVector::createVector(dim, cur, logger);
+        if (set->find(vec, norm, 0.0, ind) == ReturnCode::RC_SUCCESS) {
+            set->get(stored, ind);
+            if (stored->getCoord(0) != cur[0]) {
+                return ReturnCode::RC_UNKNOWN;
+            }
+            delete stored;
+        } else {
+            set->insert(vec, norm, 0.0);
+        }
+        delete vec;
+    }
+    if (set->getSize() != 51) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    // the first lookups of a copy build its hash table and bounds, several threads may do it at once
+    ISet * copy = set->clone();
+    std::vector<IVector *> queries;
+    for (size_t i = 0; i < 50; i++) {
+        double cur[dim] = {(double)i, 0.5 * i, 0.0};
+        queries.push_back(IVector::createVector(dim, cur, logger));
+    }
+    std::vector<int> found(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < found.size(); t++) {
+        threads.push_back(std::thread([copy, &queries, &found, norm, t]() {
+            size_t cur_ind;
+            for (auto query : queries) {
+                found[t] += copy->find(query, norm, 0.0, cur_ind) == ReturnCode::RC_SUCCESS ? 1 : 0;
+            }
+        }));
+    }
+    for (auto & thread : threads) {
+        thread.join();
+    }
+    clear_vecs(queries);
+    delete copy;
+    if (found != std::vector<int>(4, 50)) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete set;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _storage_format_test(ILogger * logger) {
+    double accuracy = 0.01;
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    const size_t dim = 2;
+    ISet * set = ISet::createSet(logger);
+    if (set->setStorageFormat(ISet::StorageFormat::QUANTIZED, 0) == ReturnCode::RC_SUCCESS ||
+        set->setStorageFormat(ISet::StorageFormat::QUANTIZED, 0.5) != ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    // grid of step 0.5 starts at the first element
+    double data[3][dim] = {{1, 1}, {2.2, 3.9}, {-0.3, 10.1}};
+    double rounded[3][dim] = {{1, 1}, {2, 4}, {-0.5, 10}};
+    for (size_t i = 0; i < 3; i++) {
+        IVector * vec = IVector::createVector(dim, data[i], logger);
+        set->insert(vec, norm, accuracy);
+        delete vec;
+    }
+    ISet * copy = set->clone();
+    copy->setStorageOrder(ISet::StorageOrder::HILBERT, 1.0);
+    for (size_t i = 0; i < 3; i++) {
+        IVector * vec = IVector::createVector(dim, rounded[i], logger);
+        size_t ind, copy_ind;
+        IVector * stored = nullptr;
+        if (set->find(vec, norm, accuracy, ind) != ReturnCode::RC_SUCCESS || ind != i ||
+            copy->find(vec, norm, accuracy, copy_ind) != ReturnCode::RC_SUCCESS ||
+            set->get(stored, ind) != ReturnCode::RC_SUCCESS || stored->getCoord(0) != rounded[i][0] || stored->getCoord(1) != rounded[i][1]) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        delete stored;
+        delete vec;
+    }
+    // queries are compared as they are, a point off the grid is not snapped to a stored one
+    double off[dim] = {2.05, 3.8};
+    IVector * off_vec = IVector::createVector(dim, off, logger);
+    size_t off_ind;
+    bool off_found;
+    if (set->find(off_vec, norm, accuracy, off_ind) != ReturnCode::RC_ELEM_NOT_FOUND ||
+        set->findBatch(off, 1, norm, accuracy, &off_ind, &off_found) != ReturnCode::RC_SUCCESS || off_found ||
+        copy->erase(off_vec, norm, accuracy) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete off_vec;
+    // tolerance widened by the storage error finds elements by their inserted coordinates
+    double error = set->getStorageError(norm);
+    if (error < 0.25 * std::sqrt(2.0) || error > 0.25 * std::sqrt(2.0) + 1e-9 ||
+        set->getStorageError(IVector::Norm::NORM_INF) < 0.25 || set->getStorageError(IVector::Norm::NORM_INF) > 0.25 + 1e-9) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    double widened = accuracy + error;
+    double queries[3 * dim];
+    size_t indices[3];
+    bool found[3];
+    for (size_t i = 0; i < 3; i++) {
+        IVector * vec = IVector::createVector(dim, data[i], logger);
+        size_t ind;
+        // the first element lies on the grid and is stored exactly
+        if ((i != 0 && set->find(vec, norm, accuracy, ind) == ReturnCode::RC_SUCCESS) ||
+            set->find(vec, norm, widened, ind) != ReturnCode::RC_SUCCESS || ind != i) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        delete vec;
+        queries[i * dim] = data[i][0];
+        queries[i * dim + 1] = data[i][1];
+    }
+    if (set->findBatch(queries, 3, norm, widened, indices, found) != ReturnCode::RC_SUCCESS ||
+        !found[0] || !found[1] || !found[2] || indices[1] != 1) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    IVector * original = IVector::createVector(dim, data[1], logger);
+    if (copy->erase(original, norm, accuracy) == ReturnCode::RC_SUCCESS ||
+        copy->erase(original, norm, widened) != ReturnCode::RC_SUCCESS || copy->getSize() != 2) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete original;
+    delete copy;
+
+    // float32 rejects coordinates out of its range, conversion keeps rounded values
+    double huge[dim] = {1e300, 0};
+    double fine[dim] = {0.1, 0.2};
+    IVector * huge_vec = IVector::createVector(dim, huge, logger);
+    IVector * fine_vec = IVector::createVector(dim, fine, logger);
+    if (set->setStorageFormat(ISet::StorageFormat::FLOAT32) != ReturnCode::RC_SUCCESS ||
+        set->getStorageFormat() != ISet::StorageFormat::FLOAT32 ||
+        set->insert(huge_vec, norm, accuracy) != ReturnCode::RC_OUT_OF_BOUNDS ||
+        set->insert(fine_vec, norm, accuracy) != ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    // the double coordinates of a point stored as floats differ from it by less than the storage error
+    size_t fine_ind;
+    if (set->find(fine_vec, norm, 0, fine_ind) == ReturnCode::RC_SUCCESS ||
+        set->find(fine_vec, norm, set->getStorageError(norm), fine_ind) != ReturnCode::RC_SUCCESS || fine_ind != 3 ||
+        set->setStorageFormat(ISet::StorageFormat::FLOAT64) != ReturnCode::RC_SUCCESS || set->getStorageError(norm) != 0) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    IVector * stored = nullptr;
+    set->get(stored, 3);
+    if (set->getSize() != 4 || stored->getCoord(0) != (double)0.1f || stored->getCoord(1) != (double)0.2f) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete stored;
+    set->erase(fine_vec, norm, accuracy);
+    if (set->getSize() != 3) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    delete huge_vec;
+    delete fine_vec;
+    delete set;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _transform_test(ILogger * logger) {
+    double accuracy = 0.15;
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    const size_t dim = 2;
+    ISet * set = ISet::createSet(logger);
+    set->setStorageOrder(ISet::StorageOrder::HILBERT, 0.5);
+    double data[4][dim] = {{0, 0}, {1, 0}, {0, 1}, {3, 3}};
+    for (size_t i = 0; i < 4; i++) {
+        IVector * vec = IVector::createVector(dim, data[i], logger);
+        set->insert(vec, norm, accuracy);
+        delete vec;
+    }
+
+    double wrong[3] = {1, 2, 3};
+    double offset[dim] = {1, 2};
+    IVector * wrong_vec = IVector::createVector(3, wrong, logger);
+    IVector * shift = IVector::createVector(dim, offset, logger);
+    if (set->translate(wrong_vec, norm, accuracy) != ReturnCode::RC_WRONG_DIM ||
+        set->translate(shift, norm, accuracy) != ReturnCode::RC_SUCCESS || set->getSize() != 4) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete wrong_vec;
+    delete shift;
+
+    // (0.1, 0.2), (0.2, 0.2), (0.1, 0.3), (0.4, 0.5): the first three collapse into one of them
+    double collapsed[dim] = {0.1, 0.2};
+    double moved[dim] = {0.4, 0.5};
+    IVector * collapsed_vec = IVector::createVector(dim, collapsed, logger);
+    IVector * moved_vec = IVector::createVector(dim, moved, logger);
+    size_t ind;
+    if (set->scale(0.1, norm, accuracy) != ReturnCode::RC_SUCCESS || set->getSize() != 2 ||
+        set->find(collapsed_vec, norm, accuracy, ind) != ReturnCode::RC_SUCCESS ||
+        set->find(moved_vec, norm, 1e-9, ind) != ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete collapsed_vec;
+    delete moved_vec;
+
+    std::vector<size_t> axes = {1};
+    std::vector<size_t> wrong_axes = {2};
+    double matrix[2] = {1, 2};
+    if (set->project(wrong_axes, norm, accuracy) != ReturnCode::RC_OUT_OF_BOUNDS ||
+        set->project(axes, norm, accuracy) != ReturnCode::RC_SUCCESS || set->getDim() != 1 ||
+        set->transform(matrix, 2, norm, accuracy) != ReturnCode::RC_SUCCESS || set->getDim() != 2 || set->getSize() != 2) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    double expected[2][dim] = {{0.2, 0.4}, {0.5, 1.0}};
+    for (size_t i = 0; i < 2; i++) {
+        IVector * vec = IVector::createVector(dim, expected[i], logger);
+        if (set->find(vec, norm, i == 0 ? 2 * accuracy : 1e-9, ind) != ReturnCode::RC_SUCCESS) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        delete vec;
+    }
+
+    // scaling by zero merges everything into the first element
+    if (set->scale(0, norm, 0) != ReturnCode::RC_SUCCESS || set->getSize() != 1) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    delete set;
+    return ReturnCode::RC_SUCCESS;
+}
+
+ReturnCode _reduction_test(ILogger * logger) {
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    const size_t dim = 2;
+    ISet * set = ISet::createSet(logger);
+    std::vector<double> min, max, mean, covariance;
+    std::vector<size_t> counts;
+    double max_norm;
+    if (ISet::statistics(set, min, max, mean, covariance, 1, logger) != ReturnCode::RC_ZERO_DIM ||
+        ISet::axisHistograms(set, 0, counts, 1, logger) != ReturnCode::RC_INVALID_PARAMS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    double data[4][dim] = {{0, 0}, {1, 0}, {0, 2}, {3, 4}};
+    for (size_t i = 0; i < 4; i++) {
+        IVector * vec = IVector::createVector(dim, data[i], logger);
+        set->insert(vec, norm, 0.5);
+        delete vec;
+    }
+
+    // the same results for one thread and for several ones
+    for (size_t threads = 1; threads <= 3; threads += 2) {
+        if (ISet::statistics(set, min, max, mean, covariance, threads, logger) != ReturnCode::RC_SUCCESS ||
+            min[0] != 0 || min[1] != 0 || max[0] != 3 || max[1] != 4 || mean[0] != 1 || mean[1] != 1.5 ||
+            std::fabs(covariance[0] - 2) > 1e-12 || std::fabs(covariance[1] - 2) > 1e-12 ||
+            std::fabs(covariance[2] - 2) > 1e-12 || std::fabs(covariance[3] - 11.0 / 3) > 1e-12) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        std::vector<size_t> axis_expected = {3, 1, 2, 2};
+        if (ISet::axisHistograms(set, 2, counts, threads, logger) != ReturnCode::RC_SUCCESS || counts != axis_expected) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+        std::vector<size_t> norm_expected = {1, 1, 1, 0, 1};
+        if (ISet::normHistogram(set, norm, 5, counts, max_norm, threads, logger) != ReturnCode::RC_SUCCESS ||
+            max_norm != 5 || counts != norm_expected) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+    }
+    delete set;
+    return ReturnCode::RC_SUCCESS;
+}
+
+struct PointsSource {
+    std::vector<double> * points;
+    size_t dim;
+    size_t pos;
+};
+
+size_t pullPoints(void * context, double * buffer, size_t maxCount) {
+    PointsSource * source = (PointsSource *)context;
+    size_t count = 0;
+    while (count < maxCount && source->pos < source->points->size()) {
+        for (size_t j = 0; j < source->dim; j++) {
+            buffer[count * source->dim + j] = (*source->points)[source->pos++];
+        }
+        count++;
+    }
+    return count;
+}
+
+struct PointsSink {
+    std::vector<double> * points;
+    size_t dim;
+};
+
+ReturnCode pushPoints(void * context, double const * points, size_t count) {
+    PointsSink * sink = (PointsSink *)context;
+    sink->points->insert(sink->points->end(), points, points + count * sink->dim);
+    return ReturnCode::RC_SUCCESS;
+}
+
+static double points_distance(double const * a, double const * b, size_t dim, IVector::Norm norm) {
+    double res = 0;
+    for (size_t j = 0; j < dim; j++) {
+        double diff = std::fabs(a[j] - b[j]);
+        switch (norm) {
+            case IVector::Norm::NORM_1:
+                res += diff;
+                break;
+            case IVector::Norm::NORM_2:
+                res += diff * diff;
+                break;
+            case IVector::Norm::NORM_INF:
+                res = std::max(res, diff);
+                break;
+        }
+    }
+    return norm == IVector::Norm::NORM_2 ? std::sqrt(res) : res;
+}
+
+// no two results are within tolerance and every input point is within tolerance of a result
+static bool dedup_valid(std::vector<double> const & points, std::vector<double> const & result, size_t dim,
+                        IVector::Norm norm, double accuracy) {
+    size_t count = points.size() / dim, result_count = result.size() / dim;
+    for (size_t i = 0; i < result_count; i++) {
+        for (size_t k = i + 1; k < result_count; k++) {
+            if (points_distance(&result[i * dim], &result[k * dim], dim, norm) < accuracy) {
+                return false;
+            }
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        bool covered = false;
+        for (size_t k = 0; k < result_count && !covered; k++) {
+            covered = points_distance(&points[i * dim], &result[k * dim], dim, norm) < accuracy;
+        }
+        if (!covered) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ReturnCode _dedup_stream_test(ILogger * logger) {
+    const size_t dim = 2, side = 20, copies = 3;
+    const double accuracy = 0.1;
+    IVector::Norm norm = IVector::Norm::NORM_2;
+    std::vector<double> points;
+    unsigned state = 11;
+    for (size_t c = 0; c < copies; c++) {
+        for (size_t i = 0; i < side * side; i++) {
+            state = state * 1103515245 + 12345;
+            size_t cell = (i * 7 + c * 13) % (side * side);
+            // wider spread along the first axis makes it the sweep axis
+            points.push_back(2.0 * (cell % side) + (state >> 16) % 100 * 1e-4);
+            points.push_back(cell / side + (state >> 8) % 100 * 1e-4);
+        }
+    }
+
+    PointsSource source = {&points, dim, 0};
+    std::vector<double> result;
+    PointsSink sink = {&result, dim};
+    size_t result_size = 0;
+    // budget for 64 points makes the stream spill several runs
+    ReturnCode r_code = ISet::dedupStream(dim, pullPoints, &source, pushPoints, &sink, norm, accuracy,
+                                          64 * 2 * dim * sizeof(double), result_size, logger);
+    if (r_code != ReturnCode::RC_SUCCESS || result_size != side * side || result.size() != side * side * dim) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    for (size_t i = 1; i < result_size; i++) {
+        if (result[i * dim] < result[(i - 1) * dim]) {
+            return ReturnCode::RC_UNKNOWN;
+        }
+    }
+    if (!dedup_valid(points, result, dim, norm, accuracy)) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    // 0.9 is dropped next to 0.0 in the merge, 1.7 is far from 0.0 though it is close to 0.9
+    std::vector<double> line = {0.9, 1.7, 0.0};
+    std::vector<double> line_result;
+    PointsSource line_source = {&line, 1, 0};
+    PointsSink line_sink = {&line_result, 1};
+    if (ISet::dedupStream(1, pullPoints, &line_source, pushPoints, &line_sink, IVector::Norm::NORM_1, 1.0,
+                          32, result_size, logger) != ReturnCode::RC_SUCCESS ||
+        !dedup_valid(line, line_result, 1, IVector::Norm::NORM_1, 1.0)) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    // clusters narrow along the sweep axis keep many points in the window, which has to go to disk;
+    // chains of points closer than tolerance cross the chunks
+    std::vector<double> clustered;
+    for (size_t i = 0; i < 150; i++) {
+        for (size_t c = 0; c < 8; c++) {
+            state = state * 1103515245 + 12345;
+            clustered.push_back(10.0 * c + (state >> 16) % 100 * 5e-4);
+            clustered.push_back(0.06 * ((i * 37) % 150));
+        }
+    }
+    std::vector<double> clustered_result;
+    PointsSource clustered_source = {&clustered, dim, 0};
+    PointsSink clustered_sink = {&clustered_result, dim};
+    if (ISet::dedupStream(dim, pullPoints, &clustered_source, pushPoints, &clustered_sink, norm, accuracy,
+                          64 * 2 * dim * sizeof(double), result_size, logger) != ReturnCode::RC_SUCCESS ||
+        clustered_result.size() != result_size * dim ||
+        !dedup_valid(clustered, clustered_result, dim, norm, accuracy)) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+
+    if (ISet::dedupStream(dim, pullPoints, &source, nullptr, &sink, norm, accuracy, 1024, result_size, logger) == ReturnCode::RC_SUCCESS) {
+        return ReturnCode::RC_UNKNOWN;
+    }
+    return ReturnCode::RC_SUCCESS;
+}
 
 void set_testing_run() {
     int client = 2;
@@ -461,6 +1544,66 @@ void set_testing_run() {
         flag = 1;
         std::cout << "set symmetric difference test failed" << std::endl;
     }
+    if (_approximate_index_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set approximate index test failed" << std::endl;
+    }
+    if (_snapshot_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set snapshot test failed" << std::endl;
+    }
+    if (_corrupted_snapshot_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set corrupted snapshot test failed" << std::endl;
+    }
+    if (_dedup_stream_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set stream deduplication test failed" << std::endl;
+    }
+    if (_bounds_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set bounds test failed" << std::endl;
+    }
+    if (_query_box_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set box query test failed" << std::endl;
+    }
+    if (_find_batch_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set batch find test failed" << std::endl;
+    }
+    if (_storage_order_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set storage order test failed" << std::endl;
+    }
+    if (_cluster_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set clustering test failed" << std::endl;
+    }
+    if (_self_join_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set self-join test failed" << std::endl;
+    }
+    if (_bloom_filter_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set Bloom filter test failed" << std::endl;
+    }
+    if (_exact_match_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set exact match test failed" << std::endl;
+    }
+    if (_storage_format_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set storage format test failed" << std::endl;
+    }
+    if (_transform_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set transform test failed" << std::endl;
+    }
+    if (_reduction_test(logger) != ReturnCode::RC_SUCCESS) {
+        flag = 1;
+        std::cout << "set reduction test failed" << std::endl;
+    }
     if (flag == 0) {
         std::cout << "ISet testing passed successfully" << std::endl;
     } else {